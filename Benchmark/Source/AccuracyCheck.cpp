@@ -0,0 +1,362 @@
+/*
+  ==============================================================================
+
+    AccuracyCheck.cpp
+    Holds every optimised DSP path to the 1.0.1 reference loop.
+
+  ==============================================================================
+*/
+
+#include "AccuracyCheck.h"
+#include "LegacyReference.h"
+#include "../../Source/PluginProcessor.h"
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int signalLength = 16384;
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+
+    // Errors are measured before the volume stage, i.e. divided by the
+    // volume gain, so one bound covers every volume setting. The kernels
+    // are within 1e-6 of the reference on each sample; the rest of the
+    // headroom is for powf() against the decoded gain, which can move an
+    // input by an ulp.
+    constexpr double maxAbsBound = 1.0e-5;
+    constexpr double rmsBound = 1.0e-6;
+
+    // what the table paths are built for; their bound adds the table's own
+    // measured error on top
+    constexpr double tableAccuracy = 1.0e-5;
+
+    const char* const modeNames[] = { "Black", "White", "Red" };
+    const float fuzzAmounts[] = { 0.0f, 0.5f, 7.5f, 15.0f, 30.0f };
+    const float gainsDb[] = { 0.0f, 6.0f, 24.0f };
+    const float volumesDb[] = { 0.0f, 24.0f };
+
+    //==============================================================================
+    struct TestSignal
+    {
+        juce::String name;
+        std::vector<float> samples;
+    };
+
+    std::vector<TestSignal> makeTestSignals()
+    {
+        std::vector<TestSignal> signals;
+
+        auto add = [&] (const char* name, auto&& generate)
+        {
+            TestSignal signal { name, std::vector<float> ((size_t) signalLength) };
+
+            for (int i = 0; i < signalLength; ++i)
+                signal.samples[(size_t) i] = generate (i);
+
+            signals.push_back (std::move (signal));
+        };
+
+        // exponential sweep over the audio band, full scale
+        add ("sweep", [] (int i)
+        {
+            const auto f0 = 20.0, f1 = 20000.0, duration = signalLength / sampleRate;
+            const auto k = std::log (f1 / f0);
+            auto t = i / sampleRate;
+            return (float) std::sin (juce::MathConstants<double>::twoPi * f0 * duration / k * (std::exp (t / duration * k) - 1.0));
+        });
+
+        juce::Random random (20211015);
+        add ("noise", [&] (int) { return random.nextFloat() * 2.0f - 1.0f; });
+
+        add ("impulses", [] (int i) { return i % 4096 == 0 ? 1.0f : (i % 4096 == 2048 ? -1.0f : 0.0f); });
+        add ("silence", [] (int) { return 0.0f; });
+        add ("DC +1", [] (int) { return 1.0f; });
+        add ("DC -1", [] (int) { return -1.0f; });
+
+        return signals;
+    }
+
+    //==============================================================================
+    struct Settings
+    {
+        int mode;
+        float fuzz, gainDb, volumeDb;
+        float mixPercent = 100.0f;
+
+        juce::String describe() const
+        {
+            return juce::String (modeNames[mode]) + ", fuzz " + juce::String (fuzz)
+                 + ", gain " + juce::String (gainDb) + " dB, volume " + juce::String (volumeDb) + " dB"
+                 + (mixPercent < 100.0f ? ", mix " + juce::String (mixPercent) + "%" : juce::String());
+        }
+    };
+
+    std::vector<float> processReference (const TestSignal& signal, const Settings& settings)
+    {
+        LegacyParameters legacy;
+        legacy.mode = (float) settings.mode;
+        legacy.fuzz = settings.fuzz;
+        legacy.gain = settings.gainDb;
+        legacy.volume = settings.volumeDb;
+
+        juce::AudioBuffer<float> buffer (1, signalLength);
+        buffer.copyFrom (0, 0, signal.samples.data(), signalLength);
+        processLegacy (buffer, legacy);
+
+        // the reference has no mix, so blend its output with the input here
+        std::vector<float> output (buffer.getReadPointer (0), buffer.getReadPointer (0) + signalLength);
+        auto mix = settings.mixPercent / 100.0f;
+
+        if (mix < 1.0f)
+            for (size_t i = 0; i < output.size(); ++i)
+                output[i] = signal.samples[i] + (output[i] - signal.samples[i]) * mix;
+
+        return output;
+    }
+
+    //==============================================================================
+    /** The worst errors one path has produced so far. */
+    class PathCheck
+    {
+    public:
+        PathCheck (juce::String name, double extraError = 0.0)
+            : _name (std::move (name)),
+              _maxAbsBound (maxAbsBound + extraError),
+              _rmsBound (rmsBound + extraError)
+        {
+        }
+
+        template <typename SampleType>
+        void compare (const std::vector<float>& reference, const SampleType* output,
+                      const TestSignal& signal, const Settings& settings)
+        {
+            auto scale = 1.0 / pandamonium::decibelsToGain (settings.volumeDb);
+            double maxAbs = 0.0, sumSquares = 0.0;
+            int worstSample = 0;
+
+            for (int i = 0; i < signalLength; ++i)
+            {
+                auto error = std::abs ((double) output[i] - (double) reference[(size_t) i]) * scale;
+
+                // a NaN must fail, not vanish in the comparisons
+                if (! (error <= maxAbs))
+                {
+                    maxAbs = std::isnan (error) ? std::numeric_limits<double>::infinity() : error;
+                    worstSample = i;
+                }
+
+                sumSquares += error * error;
+            }
+
+            auto rms = std::sqrt (sumSquares / signalLength);
+            _maxAbs = juce::jmax (_maxAbs, maxAbs);
+            _rms = juce::jmax (_rms, rms);
+
+            if (maxAbs > _maxAbsBound || rms > _rmsBound)
+            {
+                ++_numFailures;
+                std::cout << "FAIL " << _name << ": " << signal.name << ", " << settings.describe()
+                          << ": max abs " << maxAbs << " at sample " << worstSample
+                          << " (" << output[worstSample] << ", reference " << reference[(size_t) worstSample]
+                          << "), rms " << rms << std::endl;
+            }
+        }
+
+        bool passed() const     { return _numFailures == 0; }
+
+        void printSummary() const
+        {
+            std::cout << _name.paddedRight (' ', 28)
+                      << juce::String (_maxAbs, 9).paddedRight (' ', 14)
+                      << juce::String (_maxAbsBound, 9).paddedRight (' ', 14)
+                      << juce::String (_rms, 9).paddedRight (' ', 14)
+                      << juce::String (_rmsBound, 9).paddedRight (' ', 14)
+                      << (passed() ? "ok" : "FAILED (" + juce::String (_numFailures) + ")") << std::endl;
+        }
+
+    private:
+        juce::String _name;
+        double _maxAbsBound, _rmsBound;
+        double _maxAbs = 0.0, _rms = 0.0;
+        int _numFailures = 0;
+    };
+
+    //==============================================================================
+    template <typename SampleType>
+    void checkProcessor (PathCheck& check, const std::vector<TestSignal>& signals, const std::vector<Settings>& allSettings)
+    {
+        PandamoniumAudioProcessor processor;
+        processor.setPlayConfigDetails (numChannels, numChannels, sampleRate, blockSize);
+        processor.setProcessingPrecision (std::is_same<SampleType, double>::value ? juce::AudioProcessor::doublePrecision
+                                                                                  : juce::AudioProcessor::singlePrecision);
+        juce::AudioBuffer<SampleType> buffer (numChannels, blockSize);
+        juce::AudioBuffer<SampleType> output (numChannels, signalLength);
+        juce::MidiBuffer midi;
+
+        for (auto& settings : allSettings)
+        {
+            processor.setMode ((float) settings.mode);
+            processor.setFuzz (settings.fuzz);
+            processor.setGain (settings.gainDb);
+            processor.setVolume (settings.volumeDb);
+            processor.setMix (settings.mixPercent);
+
+            for (auto& signal : signals)
+            {
+                // preparing snaps the smoothers to the new gain and volume
+                processor.prepareToPlay (sampleRate, blockSize);
+
+                for (int start = 0; start < signalLength; start += blockSize)
+                {
+                    for (int channel = 0; channel < numChannels; ++channel)
+                        std::copy (signal.samples.begin() + start, signal.samples.begin() + start + blockSize,
+                                   buffer.getWritePointer (channel));
+
+                    processor.processBlock (buffer, midi);
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                        output.copyFrom (channel, start, buffer, channel, 0, blockSize);
+                }
+
+                auto reference = processReference (signal, settings);
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    check.compare (reference, output.getReadPointer (channel), signal, settings);
+            }
+        }
+
+        processor.releaseResources();
+    }
+
+    /** Calls a kernel directly on the whole signal, at a few alignments. */
+    template <typename SampleType, typename CallKernel>
+    void checkKernel (PathCheck& check, const std::vector<TestSignal>& signals, const std::vector<Settings>& allSettings,
+                      CallKernel&& callKernel)
+    {
+        std::vector<SampleType> buffer ((size_t) signalLength + 16);
+
+        for (auto& settings : allSettings)
+        {
+            for (auto& signal : signals)
+            {
+                auto reference = processReference (signal, settings);
+
+                for (auto offset : { 0, 1, 3 })
+                {
+                    auto* data = buffer.data() + offset;
+                    std::copy (signal.samples.begin(), signal.samples.end(), data);
+
+                    callKernel (data, settings);
+                    check.compare (reference, data, signal, settings);
+                }
+            }
+        }
+    }
+}
+
+//==============================================================================
+bool runAccuracyCheck()
+{
+    using namespace pandamonium;
+
+    const auto signals = makeTestSignals();
+
+    std::vector<Settings> allSettings, blackSettings, mixedSettings;
+
+    for (int mode = 0; mode < numFuzzModes; ++mode)
+        for (auto fuzz : fuzzAmounts)
+            for (auto gainDb : gainsDb)
+                for (auto volumeDb : volumesDb)
+                    allSettings.push_back ({ mode, fuzz, gainDb, volumeDb });
+
+    std::copy_if (allSettings.begin(), allSettings.end(), std::back_inserter (blackSettings),
+                  [] (const Settings& s) { return s.mode == (int) FuzzMode::Black; });
+
+    for (auto settings : allSettings)
+    {
+        settings.mixPercent = 50.0f;
+        mixedSettings.push_back (settings);
+    }
+
+    // reserved so the reference to back() stays put while each path runs
+    std::vector<PathCheck> checks;
+    checks.reserve (64);
+
+    checks.emplace_back ("processBlock");
+    checkProcessor<float> (checks.back(), signals, allSettings);
+
+    checks.emplace_back ("processBlock, double");
+    checkProcessor<double> (checks.back(), signals, allSettings);
+
+    checks.emplace_back ("processBlock, 50% mix");
+    checkProcessor<float> (checks.back(), signals, mixedSettings);
+
+    for (auto isa : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2,
+                      InstructionSet::AVX512, InstructionSet::NEON })
+    {
+        auto& kernels = getFuzzKernels (isa);
+
+        if (kernels.instructionSet != isa)
+            continue;
+
+        checks.emplace_back (juce::String (getInstructionSetName (isa)) + " kernels");
+        checkKernel<float> (checks.back(), signals, allSettings, [&] (float* data, const Settings& s)
+        {
+            auto p = FuzzParameters::fromRaw (s.gainDb, s.fuzz, s.volumeDb, (float) s.mode);
+            kernels.get (p.mode) (data, signalLength, { p.gain, 0.0f }, { p.volume, 0.0f }, { p.mix, 0.0f }, p.fuzz);
+        });
+
+        // the all-channels kernel, split into blocks so the start offset
+        // moves, fully wet and half mixed
+        auto callChannelKernel = [&] (float* data, const Settings& s)
+        {
+            auto p = FuzzParameters::fromRaw (s.gainDb, s.fuzz, s.volumeDb, (float) s.mode, s.mixPercent);
+            float* channels[] = { data };
+
+            for (int start = 0; start < signalLength; start += blockSize - 1)
+                kernels.getForChannels (p.mode) (channels, 1, start, juce::jmin (blockSize - 1, signalLength - start),
+                                                 { p.gain, 0.0f }, { p.volume, 0.0f }, { p.mix, 0.0f }, p.fuzz);
+        };
+
+        checks.emplace_back (juce::String (getInstructionSetName (isa)) + " channel kernels");
+        checkKernel<float> (checks.back(), signals, allSettings, callChannelKernel);
+
+        checks.emplace_back (juce::String (getInstructionSetName (isa)) + " channel kernels, mix");
+        checkKernel<float> (checks.back(), signals, mixedSettings, callChannelKernel);
+
+        checks.emplace_back (juce::String (getInstructionSetName (isa)) + " double kernels");
+        checkKernel<double> (checks.back(), signals, allSettings, [&] (double* data, const Settings& s)
+        {
+            auto p = FuzzParameters::fromRaw (s.gainDb, s.fuzz, s.volumeDb, (float) s.mode);
+            kernels.get<double> (p.mode) (data, signalLength, { p.gain, 0.0f }, { p.volume, 0.0f }, { p.mix, 0.0f }, p.fuzz);
+        });
+
+        for (auto interpolation : { Interpolation::Linear, Interpolation::Cubic })
+        {
+            auto table = WaveshaperTable::forAccuracy (tableAccuracy, interpolation);
+            auto name = juce::String (getInstructionSetName (isa)) + " Black table, "
+                      + (interpolation == Interpolation::Linear ? "linear" : "cubic");
+
+            checks.emplace_back (name, table.getMaxError());
+            checkKernel<float> (checks.back(), signals, blackSettings, [&] (float* data, const Settings& s)
+            {
+                auto p = FuzzParameters::fromRaw (s.gainDb, s.fuzz, s.volumeDb, (float) s.mode);
+                kernels.getBlackTable (interpolation) (data, signalLength, { p.gain, 0.0f }, { p.volume, 0.0f }, { p.mix, 0.0f },
+                                                       p.fuzz, table);
+            });
+        }
+    }
+
+    std::cout << std::endl << "path                        max abs       bound         rms           bound" << std::endl;
+
+    bool passed = true;
+
+    for (auto& check : checks)
+    {
+        check.printSummary();
+        passed = passed && check.passed();
+    }
+
+    std::cout << std::endl << (passed ? "all paths within tolerance" : "ACCURACY CHECK FAILED") << std::endl;
+    return passed;
+}
@@ -0,0 +1,21 @@
+/*
+  ==============================================================================
+
+    AccuracyCheck.h
+    Holds every optimised DSP path to the 1.0.1 reference loop.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/** Runs sweeps, noise, impulses, silence and full-scale DC through every
+    mode and setting, once through the 1.0.1 loop in LegacyReference.h and
+    once through each fast path: processBlock itself in float and in
+    double, then every float and double kernel and lookup table this CPU
+    can run, called directly.
+
+    Prints the worst max-abs and RMS error of each path against its bound,
+    and every case that breaks one. Returns false if any did.
+*/
+bool runAccuracyCheck();
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    LegacyReference.h
+    The 1.0.1 processBlock loop, for timing against and checking accuracy.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// The 1.0.1 inner loop, kept verbatim (atomics read and powf called per
+// sample) so the benchmark has something to measure against, and so the
+// accuracy check has something to hold every faster path to.
+struct LegacyParameters
+{
+    std::atomic<float> gain { 1.0f }, fuzz { 15.0f }, volume { 1.0f }, mode { 0.0f };
+};
+
+inline void processLegacy (juce::AudioBuffer<float>& buffer, const LegacyParameters& p)
+{
+    auto* _gain = &p.gain;
+    auto* _fuzz = &p.fuzz;
+    auto* _volume = &p.volume;
+    auto* _mode = &p.mode;
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        auto* channelData = buffer.getWritePointer (channel);
+
+        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+        {
+            auto input = channelData[sample];
+            float gain = powf(10.0f, *_gain / 20.f);
+            float x = input * gain;
+
+            if (*_mode == 0)
+            {
+                if (x < 0)
+                    x = -1.0f + exp(x * *_fuzz);
+                else
+                    x = 1.0f - exp(-x * *_fuzz);
+            }
+            else if (*_mode == 1)
+            {
+                float threshold = 1.0f / 3.0f;
+                float fuzz = 6.0f * (*_fuzz / 30.0f);
+
+                if (x > threshold)
+                {
+                    if (x > 2.0f * threshold)
+                        x = 1.0f;
+                    else
+                        x = (3.0f - (2.0f - fuzz*x) * (2.0f - fuzz*x)) / 3.0f;
+                }
+                else if (x < -threshold)
+                {
+                    if (x < -2.0f * threshold)
+                        x = -1.0f;
+                    else
+                        x = -(3.0f - (2.0f - fuzz*x) * (2.0f - fuzz*x)) / 3.0f;
+                }
+                else
+                {
+                    x *= 2.0f;
+                }
+
+                x /= 2.0f;
+            }
+            else
+            {
+                float threshold = 1 - *_fuzz / 30.0f;
+
+                if (x > threshold)
+                    x = 1;
+                else if (x < -threshold)
+                    x = -1;
+            }
+
+            float volume = powf(10.0f, *_volume / 20.f);
+            channelData[sample] = x * volume;
+        }
+    }
+}
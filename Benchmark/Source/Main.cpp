@@ -0,0 +1,509 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Headless benchmark for PandamoniumAudioProcessor.
+
+    With no arguments it prints a report comparing kernels, tables,
+    oversampling and anti-aliasing. With --json it sweeps sample rates,
+    block sizes, channel counts, modes and fuzz amounts and writes the
+    results as JSON, to stdout or to the file given with --output=path.
+    With --verify it runs the accuracy check in AccuracyCheck.h and exits
+    non-zero if any path has drifted from 1.0.1. With --realtime-check it
+    runs the instrumented session in RealtimeCheck.h and exits non-zero if
+    processBlock allocated, freed or locked anything. With
+    --render-scaling[=file] it times the renderer splitting one file
+    across more and more threads, as in RenderScaling.h, and exits non-zero
+    if any split render differs from the serial one. With
+    --read-paths[=file] it compares the renderer's streaming and
+    memory-mapped readers on cold and warm page caches, as in ReadPaths.h.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include "AccuracyCheck.h"
+#include "ReadPaths.h"
+#include "RealtimeCheck.h"
+#include "RenderScaling.h"
+#include "LegacyReference.h"
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+    constexpr int numBlocks = 20000;
+
+    const char* const modeNames[] = { "Black", "White", "Red" };
+
+    //==============================================================================
+    template <typename SampleType>
+    void fillWithNoise (juce::AudioBuffer<SampleType>& buffer)
+    {
+        juce::Random random (1234);
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+                buffer.setSample (channel, sample, (SampleType) (random.nextFloat() * 2.0f - 1.0f));
+    }
+
+    /** Runs process over numBlocks blocks and returns nanoseconds per sample,
+        i.e. per channel.
+    */
+    template <typename SampleType = float, typename ProcessFn>
+    double timeNanosPerSample (ProcessFn&& process, int channels = numChannels)
+    {
+        juce::AudioBuffer<SampleType> source (channels, blockSize);
+        juce::AudioBuffer<SampleType> buffer (channels, blockSize);
+        fillWithNoise (source);
+
+        // warm up
+        for (int i = 0; i < 100; ++i)
+        {
+            buffer.makeCopyOf (source, true);
+            process (buffer);
+        }
+
+        auto start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            buffer.makeCopyOf (source, true);
+            process (buffer);
+        }
+
+        auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+        return seconds * 1.0e9 / ((double) numBlocks * blockSize * channels);
+    }
+
+    //==============================================================================
+    // A sine on an exact FFT bin, so once the processor has settled its output
+    // repeats every fftSize samples and needs no window. Every harmonic below
+    // Nyquist then lands on a multiple of sineBin; anything else is aliasing.
+    constexpr int fftOrder = 14;
+    constexpr int fftSize = 1 << fftOrder;
+    constexpr int sineBin = 1707;       // about 5 kHz at 48 kHz, and odd so no alias lands on a harmonic
+    constexpr int settleSamples = 16384;
+
+    /** Power of everything but DC and the harmonics, relative to the
+        harmonics, in dB.
+    */
+    double measureAliasing (PandamoniumAudioProcessor& processor, juce::MidiBuffer& midi)
+    {
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+        std::vector<float> output;
+        output.reserve ((size_t) (settleSamples + fftSize));
+
+        for (int start = 0; start < settleSamples + fftSize; start += blockSize)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample (channel, i, 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * sineBin * (start + i) / fftSize));
+
+            processor.processBlock (buffer, midi);
+            output.insert (output.end(), buffer.getReadPointer (0), buffer.getReadPointer (0) + blockSize);
+        }
+
+        std::vector<float> spectrum (2 * fftSize, 0.0f);
+        std::copy (output.end() - fftSize, output.end(), spectrum.begin());
+        juce::dsp::FFT (fftOrder).performFrequencyOnlyForwardTransform (spectrum.data());
+
+        double harmonics = 0.0, aliases = 0.0;
+
+        for (int bin = 1; bin < fftSize / 2; ++bin)
+        {
+            auto power = (double) spectrum[(size_t) bin] * spectrum[(size_t) bin];
+            (bin % sineBin == 0 ? harmonics : aliases) += power;
+        }
+
+        return 10.0 * std::log10 (aliases / harmonics);
+    }
+
+    //==============================================================================
+    // the --json sweep
+    const double matrixSampleRates[] = { 44100.0, 48000.0, 96000.0 };
+    const int matrixBlockSizes[] = { 32, 128, 512, 2048 };
+    const int matrixChannelCounts[] = { 1, 2, 6, 12, 16 };
+    const float matrixFuzzAmounts[] = { 0.0f, 15.0f, 30.0f };
+
+    // enough per point to swamp timer resolution without the sweep taking all day
+    constexpr int matrixSamplesPerPoint = 1 << 20;
+
+    /** Seconds taken to push numSamples samples per channel of noise through
+        processor, block by block, after a short warm up.
+    */
+    double timeProcessor (PandamoniumAudioProcessor& processor, int channels, int samplesPerBlock, int numSamples)
+    {
+        juce::AudioBuffer<float> source (channels, samplesPerBlock);
+        juce::AudioBuffer<float> buffer (channels, samplesPerBlock);
+        juce::MidiBuffer midi;
+        fillWithNoise (source);
+
+        auto numBlocksToRun = juce::jmax (1, numSamples / samplesPerBlock);
+
+        for (int i = 0; i < juce::jmin (100, numBlocksToRun); ++i)
+        {
+            buffer.makeCopyOf (source, true);
+            processor.processBlock (buffer, midi);
+        }
+
+        auto start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numBlocksToRun; ++i)
+        {
+            buffer.makeCopyOf (source, true);
+            processor.processBlock (buffer, midi);
+        }
+
+        return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+    }
+
+    juce::var runMatrix()
+    {
+        juce::Array<juce::var> results;
+
+        for (auto rate : matrixSampleRates)
+        {
+            for (auto samplesPerBlock : matrixBlockSizes)
+            {
+                for (auto channels : matrixChannelCounts)
+                {
+                    // a fresh instance per configuration, as a host would make
+                    PandamoniumAudioProcessor processor;
+                    processor.setPlayConfigDetails (channels, channels, rate, samplesPerBlock);
+                    processor.prepareToPlay (rate, samplesPerBlock);
+
+                    for (int mode = 0; mode < 3; ++mode)
+                    {
+                        for (auto fuzz : matrixFuzzAmounts)
+                        {
+                            processor.setMode ((float) mode);
+                            processor.setFuzz (fuzz);
+
+                            auto numBlocksRun = juce::jmax (1, matrixSamplesPerPoint / samplesPerBlock);
+                            auto samplesRun = (double) numBlocksRun * samplesPerBlock;
+                            auto seconds = timeProcessor (processor, channels, samplesPerBlock, matrixSamplesPerPoint);
+
+                            // realtime factor: seconds of audio per second of CPU;
+                            // instances per core is the whole number of those
+                            auto realtimeFactor = (samplesRun / rate) / seconds;
+
+                            auto* point = new juce::DynamicObject();
+                            point->setProperty ("sampleRate", rate);
+                            point->setProperty ("blockSize", samplesPerBlock);
+                            point->setProperty ("channels", channels);
+                            point->setProperty ("mode", modeNames[mode]);
+                            point->setProperty ("fuzz", fuzz);
+                            point->setProperty ("nsPerSample", seconds * 1.0e9 / (samplesRun * channels));
+                            point->setProperty ("realtimeFactor", realtimeFactor);
+                            point->setProperty ("instancesPerCore", (int) std::floor (realtimeFactor));
+                            results.add (juce::var (point));
+                        }
+                    }
+
+                    processor.releaseResources();
+                }
+            }
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty ("plugin", JucePlugin_Name);
+        root->setProperty ("kernels", pandamonium::getInstructionSetName (pandamonium::getPreferredInstructionSet()));
+        root->setProperty ("os", juce::SystemStats::getOperatingSystemName());
+        root->setProperty ("cpu", juce::SystemStats::getCpuModel());
+        root->setProperty ("time", juce::Time::getCurrentTime().toISO8601 (true));
+        root->setProperty ("samplesPerPoint", matrixSamplesPerPoint);
+        root->setProperty ("results", results);
+        return juce::var (root);
+    }
+}
+
+//==============================================================================
+static void runReport()
+{
+    PandamoniumAudioProcessor processor;
+    processor.setPlayConfigDetails (numChannels, numChannels, sampleRate, blockSize);
+    processor.prepareToPlay (sampleRate, blockSize);
+
+    juce::MidiBuffer midi;
+    LegacyParameters legacy;
+
+    std::cout << "kernels: " << pandamonium::getInstructionSetName (processor.getInstructionSet())
+              << " (set PANDAMONIUM_ISA to scalar, sse2, avx2, avx512 or neon to force one)" << std::endl;
+
+    std::cout << "mode     legacy ns/sample   current ns/sample   speedup" << std::endl;
+
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        legacy.mode = (float) mode;
+        processor.setMode ((float) mode);
+
+        auto before = timeNanosPerSample ([&] (juce::AudioBuffer<float>& b) { processLegacy (b, legacy); });
+        auto after = timeNanosPerSample ([&] (juce::AudioBuffer<float>& b) { processor.processBlock (b, midi); });
+
+        std::cout << juce::String (modeNames[mode]).paddedRight (' ', 9)
+                  << juce::String (before, 3).paddedRight (' ', 19)
+                  << juce::String (after, 3).paddedRight (' ', 20)
+                  << juce::String (before / after, 2) << "x" << std::endl;
+    }
+
+    // silent input skips the DSP once nothing is left ringing
+    processor.setMode (0.0f);
+    auto loud = timeNanosPerSample ([&] (juce::AudioBuffer<float>& b) { processor.processBlock (b, midi); });
+    auto silent = timeNanosPerSample ([&] (juce::AudioBuffer<float>& b) { b.clear(); processor.processBlock (b, midi); });
+
+    std::cout << std::endl << "silent input: " << juce::String (silent, 3) << " ns/sample against "
+              << juce::String (loud, 3) << " for noise (Black)" << std::endl;
+
+    // bypass after its fade, still delaying the input by 8x FIR latency
+    processor.setOversampling (3.0f);
+    processor.setOversamplingFilter (1.0f);
+    auto processing = timeNanosPerSample ([&] (juce::AudioBuffer<float>& b) { processor.processBlock (b, midi); });
+    auto bypassed = timeNanosPerSample ([&] (juce::AudioBuffer<float>& b) { processor.processBlockBypassed (b, midi); });
+
+    std::cout << "bypassed: " << juce::String (bypassed, 3) << " ns/sample against "
+              << juce::String (processing, 3) << " processing (Black, 8x FIR, "
+              << processor.getProcessingLatencySamples() << " samples latency)" << std::endl;
+
+    processor.setOversampling (0.0f);
+    processor.setOversamplingFilter (0.0f);
+
+    // the dry/wet blend happens inside the kernel, so it should cost next
+    // to nothing over fully wet
+    processor.setMix (50.0f);
+    auto mixed = timeNanosPerSample ([&] (juce::AudioBuffer<float>& b) { processor.processBlock (b, midi); });
+    processor.setMix (100.0f);
+
+    std::cout << "50% mix: " << juce::String (mixed, 3) << " ns/sample against "
+              << juce::String (loud, 3) << " fully wet (Black)" << std::endl;
+
+    // timestamped automation, from none up to a change on every sample,
+    // which the minimum sub-block size holds to one every 16
+    std::cout << std::endl << "fuzz events per block   ns/sample (Black)" << std::endl;
+
+    for (auto eventsPerBlock : { 0, 8, 64, blockSize })
+    {
+        auto nanos = timeNanosPerSample ([&] (juce::AudioBuffer<float>& b)
+        {
+            for (int i = 0; i < eventsPerBlock; ++i)
+                processor.addParameterEvent (i * blockSize / eventsPerBlock, pandamonium::AutomatedParameter::Fuzz,
+                                             i % 2 == 0 ? 10.0f : 20.0f);
+
+            processor.processBlock (b, midi);
+        });
+
+        std::cout << juce::String (eventsPerBlock).paddedRight (' ', 24) << juce::String (nanos, 3) << std::endl;
+    }
+
+    // leave fuzz back at the host's value
+    processor.prepareToPlay (sampleRate, blockSize);
+
+    // per-channel cost from mono up to 16 channels
+    std::cout << std::endl << "layout           channels   ns/sample (Black)" << std::endl;
+
+    const std::pair<const char*, juce::AudioChannelSet> layouts[] = {
+        { "mono", juce::AudioChannelSet::mono() },
+        { "stereo", juce::AudioChannelSet::stereo() },
+        { "5.1", juce::AudioChannelSet::create5point1() },
+        { "7.1.4", juce::AudioChannelSet::create7point1point4() },
+        { "16 discrete", juce::AudioChannelSet::discreteChannels (16) } };
+
+    for (auto& layout : layouts)
+    {
+        juce::AudioProcessor::BusesLayout busesLayout;
+        busesLayout.inputBuses.add (layout.second);
+        busesLayout.outputBuses.add (layout.second);
+
+        PandamoniumAudioProcessor multichannel;
+        multichannel.setBusesLayout (busesLayout);
+        multichannel.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        multichannel.prepareToPlay (sampleRate, blockSize);
+
+        auto channels = layout.second.size();
+        auto nanos = timeNanosPerSample ([&] (juce::AudioBuffer<float>& b) { multichannel.processBlock (b, midi); }, channels);
+
+        std::cout << juce::String (layout.first).paddedRight (' ', 17)
+                  << juce::String (channels).paddedRight (' ', 11)
+                  << juce::String (nanos, 3) << std::endl;
+
+        multichannel.releaseResources();
+    }
+
+    // Black mode through the lookup table instead of exp()
+    std::cout << std::endl << "Black mode table   max error     ns/sample   vs exp()" << std::endl;
+
+    processor.setMode (0.0f);
+    processor.setBlackModeTable (0, pandamonium::Interpolation::Linear);
+    auto exact = timeNanosPerSample ([&] (juce::AudioBuffer<float>& b) { processor.processBlock (b, midi); });
+
+    for (auto interpolation : { pandamonium::Interpolation::Linear, pandamonium::Interpolation::Cubic })
+    {
+        for (auto numPoints : { 256, 1024, 4096, 16384 })
+        {
+            processor.setBlackModeTable (numPoints, interpolation);
+            auto withTable = timeNanosPerSample ([&] (juce::AudioBuffer<float>& b) { processor.processBlock (b, midi); });
+
+            auto name = juce::String (interpolation == pandamonium::Interpolation::Linear ? "linear " : "cubic ") + juce::String (numPoints);
+
+            std::cout << name.paddedRight (' ', 19)
+                      << juce::String (processor.getBlackModeTableError(), 9).paddedRight (' ', 14)
+                      << juce::String (withTable, 3).paddedRight (' ', 12)
+                      << juce::String (exact / withTable, 2) << "x" << std::endl;
+        }
+    }
+
+    processor.setBlackModeTable (0, pandamonium::Interpolation::Linear);
+
+    // what each oversampling factor costs, per host-rate sample
+    std::cout << std::endl << "oversampling   filter   latency   ns/sample (Black)" << std::endl;
+
+    const char* const filterNames[] = { "IIR", "FIR" };
+
+    for (int filter = 0; filter < 2; ++filter)
+    {
+        for (int stages = 0; stages <= 3; ++stages)
+        {
+            processor.setOversampling ((float) stages);
+            processor.setOversamplingFilter ((float) filter);
+            auto nanos = timeNanosPerSample ([&] (juce::AudioBuffer<float>& b) { processor.processBlock (b, midi); });
+
+            std::cout << (juce::String (1 << stages) + "x").paddedRight (' ', 15)
+                      << juce::String (filterNames[filter]).paddedRight (' ', 9)
+                      << juce::String (processor.getProcessingLatencySamples()).paddedRight (' ', 10)
+                      << juce::String (nanos, 3) << std::endl;
+        }
+    }
+
+    processor.setOversampling (0.0f);
+    processor.setOversamplingFilter (0.0f);
+
+    // A host running in double either gets double all the way through, or
+    // has to convert every block to float and back around the float path
+    std::cout << std::endl << "double buffers   mode     float ns/sample   via float   native double" << std::endl;
+
+    PandamoniumAudioProcessor doubleProcessor;
+    doubleProcessor.setPlayConfigDetails (numChannels, numChannels, sampleRate, blockSize);
+    doubleProcessor.setProcessingPrecision (juce::AudioProcessor::doublePrecision);
+    doubleProcessor.prepareToPlay (sampleRate, blockSize);
+
+    juce::AudioBuffer<float> converted (numChannels, blockSize);
+
+    for (int stages : { 0, 2 })
+    {
+        for (int mode = 0; mode < 3; ++mode)
+        {
+            for (auto* p : { &processor, &doubleProcessor })
+            {
+                p->setMode ((float) mode);
+                p->setOversampling ((float) stages);
+            }
+
+            auto single = timeNanosPerSample ([&] (juce::AudioBuffer<float>& b) { processor.processBlock (b, midi); });
+
+            auto viaFloat = timeNanosPerSample<double> ([&] (juce::AudioBuffer<double>& b)
+            {
+                converted.makeCopyOf (b, true);
+                processor.processBlock (converted, midi);
+                b.makeCopyOf (converted, true);
+            });
+
+            auto native = timeNanosPerSample<double> ([&] (juce::AudioBuffer<double>& b) { doubleProcessor.processBlock (b, midi); });
+
+            std::cout << (juce::String (1 << stages) + "x").paddedRight (' ', 17)
+                      << juce::String (modeNames[mode]).paddedRight (' ', 9)
+                      << juce::String (single, 3).paddedRight (' ', 18)
+                      << juce::String (viaFloat, 3).paddedRight (' ', 12)
+                      << juce::String (native, 3) << std::endl;
+        }
+    }
+
+    doubleProcessor.releaseResources();
+    processor.setOversampling (0.0f);
+
+    // ADAA against oversampling, on a sine driven well into every mode
+    std::cout << std::endl << "anti-aliasing   mode     aliasing dB   ns/sample" << std::endl;
+
+    struct AntialiasingSetup
+    {
+        const char* name;
+        int oversamplingStages;
+        bool adaa;
+        bool offline;
+    };
+
+    const AntialiasingSetup setups[] = { { "none", 0, false, false }, { "ADAA", 0, true, false },
+                                         { "2x", 1, false, false }, { "4x", 2, false, false },
+                                         { "8x", 3, false, false }, { "ADAA + 2x", 1, true, false },
+                                         { "offline (HQ)", 0, false, true } };
+
+    processor.setGain (12.0f);
+
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        processor.setMode ((float) mode);
+
+        for (auto& setup : setups)
+        {
+            processor.setOversampling ((float) setup.oversamplingStages);
+            processor.setAntialiasing (setup.adaa ? 1.0f : 0.0f);
+            processor.setNonRealtime (setup.offline);
+
+            auto aliasing = measureAliasing (processor, midi);
+            auto nanos = timeNanosPerSample ([&] (juce::AudioBuffer<float>& b) { processor.processBlock (b, midi); });
+
+            std::cout << juce::String (setup.name).paddedRight (' ', 16)
+                      << juce::String (modeNames[mode]).paddedRight (' ', 9)
+                      << juce::String (aliasing, 1).paddedRight (' ', 14)
+                      << juce::String (nanos, 3) << std::endl;
+        }
+    }
+
+    processor.setGain (1.0f);
+    processor.setNonRealtime (false);
+    processor.setAntialiasing (0.0f);
+    processor.setOversampling (0.0f);
+    processor.releaseResources();
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--verify"))
+        return runAccuracyCheck() ? 0 : 1;
+
+    if (args.containsOption ("--realtime-check"))
+        return runRealtimeCheck() ? 0 : 1;
+
+    if (args.containsOption ("--render-scaling"))
+    {
+        auto path = args.getValueForOption ("--render-scaling");
+        return runRenderScaling (path.isEmpty() ? juce::File() : juce::File::getCurrentWorkingDirectory().getChildFile (path)) ? 0 : 1;
+    }
+
+    if (args.containsOption ("--read-paths"))
+    {
+        auto path = args.getValueForOption ("--read-paths");
+        return runReadPathBenchmark (path.isEmpty() ? juce::File() : juce::File::getCurrentWorkingDirectory().getChildFile (path)) ? 0 : 1;
+    }
+
+    if (! args.containsOption ("--json"))
+    {
+        runReport();
+        return 0;
+    }
+
+    auto json = juce::JSON::toString (runMatrix());
+
+    auto output = args.getValueForOption ("--output");
+
+    if (output.isNotEmpty())
+        return juce::File::getCurrentWorkingDirectory().getChildFile (output).replaceWithText (json) ? 0 : 1;
+
+    std::cout << json << std::endl;
+    return 0;
+}
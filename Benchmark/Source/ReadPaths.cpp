@@ -0,0 +1,248 @@
+/*
+  ==============================================================================
+
+    ReadPaths.cpp
+    The renderer's streaming and memory-mapped readers, head to head.
+
+  ==============================================================================
+*/
+
+#include "ReadPaths.h"
+#include "../../Renderer/Source/FileRenderer.h"
+
+#if JUCE_LINUX
+ #include <fcntl.h>
+ #include <sys/resource.h>
+ #include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+    constexpr double lengthSeconds = 600.0;
+    constexpr int blockSize = 4096;
+
+    bool writeTestFile (const juce::File& file)
+    {
+        file.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream (file.createOutputStream());
+
+        if (stream == nullptr)
+            return false;
+
+        std::unique_ptr<juce::AudioFormatWriter> writer (juce::WavAudioFormat().createWriterFor (stream.get(), sampleRate, numChannels,
+                                                                                                 24, {}, 0));
+
+        if (writer == nullptr)
+            return false;
+
+        stream.release();
+
+        juce::Random random (4242);
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+
+        for (juce::int64 position = 0; position < (juce::int64) (lengthSeconds * sampleRate); position += blockSize)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample (channel, i, 0.5f * (random.nextFloat() * 2.0f - 1.0f));
+
+            if (! writer->writeFromAudioSampleBuffer (buffer, 0, blockSize))
+                return false;
+        }
+
+        return true;
+    }
+
+    //==============================================================================
+    /** What the process has done so far, where the OS will say. */
+    struct Counters
+    {
+        juce::int64 readCalls = 0, writeCalls = 0;
+        juce::int64 minorFaults = 0, majorFaults = 0;
+
+        static Counters now()
+        {
+            Counters c;
+
+           #if JUCE_LINUX
+            auto lines = juce::StringArray::fromLines (juce::File ("/proc/self/io").loadFileAsString());
+
+            for (auto& line : lines)
+            {
+                if (line.startsWith ("syscr:"))     c.readCalls = line.fromFirstOccurrenceOf (":", false, false).trim().getLargeIntValue();
+                if (line.startsWith ("syscw:"))     c.writeCalls = line.fromFirstOccurrenceOf (":", false, false).trim().getLargeIntValue();
+            }
+
+            rusage usage {};
+            getrusage (RUSAGE_SELF, &usage);
+            c.minorFaults = usage.ru_minflt;
+            c.majorFaults = usage.ru_majflt;
+           #endif
+
+            return c;
+        }
+
+        Counters operator- (const Counters& other) const
+        {
+            return { readCalls - other.readCalls, writeCalls - other.writeCalls,
+                     minorFaults - other.minorFaults, majorFaults - other.majorFaults };
+        }
+    };
+
+    /** Polls the resident set size while it runs and keeps the largest. */
+    class ResidentSampler : private juce::Thread
+    {
+    public:
+        ResidentSampler() : juce::Thread ("resident sampler"), _baseline (getResidentBytes())
+        {
+            _peak = _baseline;
+            startThread();
+        }
+
+        ~ResidentSampler() override
+        {
+            stopThread (1000);
+        }
+
+        /** How far above where it started memory went, in MB. */
+        double getPeakMegabytes()
+        {
+            stopThread (1000);
+            return (double) (_peak.load() - _baseline) / (1024.0 * 1024.0);
+        }
+
+    private:
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                auto resident = getResidentBytes();
+
+                if (resident > _peak.load())
+                    _peak = resident;
+
+                wait (2);
+            }
+        }
+
+        static juce::int64 getResidentBytes()
+        {
+           #if JUCE_LINUX
+            auto fields = juce::StringArray::fromTokens (juce::File ("/proc/self/statm").loadFileAsString(), false);
+            return fields[1].getLargeIntValue() * (juce::int64) sysconf (_SC_PAGESIZE);
+           #else
+            return 0;
+           #endif
+        }
+
+        const juce::int64 _baseline;
+        std::atomic<juce::int64> _peak { 0 };
+    };
+
+    /** Drops file from the page cache, as far as the OS lets us. */
+    void evictFromCache (const juce::File& file)
+    {
+       #if JUCE_LINUX
+        auto fd = open (file.getFullPathName().toRawUTF8(), O_RDONLY);
+
+        if (fd >= 0)
+        {
+            posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED);
+            close (fd);
+        }
+       #else
+        juce::ignoreUnused (file);
+       #endif
+    }
+
+    /** Reads every sample of input the way the renderer does. */
+    bool readThrough (const juce::File& input, const RenderSettings& settings)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        auto reader = openReader (formats, input, settings);
+
+        if (reader == nullptr)
+            return false;
+
+        juce::AudioBuffer<float> buffer ((int) reader->numChannels, blockSize);
+
+        for (juce::int64 position = 0; position < reader->lengthInSamples; position += blockSize)
+            if (! readBlock (*reader, buffer, position, blockSize))
+                return false;
+
+        return true;
+    }
+}
+
+//==============================================================================
+bool runReadPathBenchmark (const juce::File& input)
+{
+    juce::TemporaryFile testFile (".wav");
+    auto source = input;
+
+    if (source == juce::File())
+    {
+        std::cout << "writing " << lengthSeconds << " s of test audio" << std::endl;
+
+        if (! writeTestFile (testFile.getFile()))
+        {
+            std::cout << "couldn't write " << testFile.getFile().getFullPathName() << std::endl;
+            return false;
+        }
+
+        source = testFile.getFile();
+    }
+
+    std::cout << source.getFileName() << ", " << juce::File::descriptionOfSizeInBytes (source.getSize()) << std::endl
+              << std::endl
+              << "reader     cache   pass     seconds   read calls   write calls   minor faults   major faults   peak MB" << std::endl;
+
+    auto succeeded = true;
+
+    for (auto mapped : { false, true })
+    {
+        RenderSettings settings;
+        settings.memoryMapped = mapped;
+
+        for (auto cold : { true, false })
+        {
+            for (auto render : { false, true })
+            {
+                juce::TemporaryFile output (".wav");
+
+                if (cold)
+                    evictFromCache (source);
+                else
+                    readThrough (source, settings);
+
+                auto before = Counters::now();
+                ResidentSampler resident;
+                auto start = juce::Time::getMillisecondCounterHiRes();
+
+                auto ok = render ? renderFile (source, output.getFile(), settings).wasOk()
+                                 : readThrough (source, settings);
+
+                auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+                auto peak = resident.getPeakMegabytes();
+                auto counters = Counters::now() - before;
+                succeeded = succeeded && ok;
+
+                std::cout << juce::String (mapped ? "mapped" : "streamed").paddedRight (' ', 11)
+                          << juce::String (cold ? "cold" : "warm").paddedRight (' ', 8)
+                          << juce::String (render ? "render" : "read").paddedRight (' ', 9)
+                          << (ok ? juce::String (seconds, 3) : juce::String ("failed")).paddedRight (' ', 10)
+                          << juce::String (counters.readCalls).paddedRight (' ', 13)
+                          << juce::String (counters.writeCalls).paddedRight (' ', 14)
+                          << juce::String (counters.minorFaults).paddedRight (' ', 15)
+                          << juce::String (counters.majorFaults).paddedRight (' ', 15)
+                          << juce::String (peak, 1) << std::endl;
+            }
+        }
+    }
+
+    return succeeded;
+}
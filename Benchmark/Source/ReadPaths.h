@@ -0,0 +1,25 @@
+/*
+  ==============================================================================
+
+    ReadPaths.h
+    The renderer's streaming and memory-mapped readers, head to head.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Reads input all the way through, then renders it, once through a stream
+    and once through a memory map, each from a cold and from a warm page
+    cache, and prints the time of each. On Linux it also prints the read
+    and write system calls made, the page faults taken and the most memory
+    resident at once above where it started; the cold runs evict input
+    from the page cache first with posix_fadvise, elsewhere they're as warm
+    as the OS leaves them.
+
+    Without an input file, ten minutes of 24-bit stereo noise are made up
+    to read. Returns false if anything fails to read or render.
+*/
+bool runReadPathBenchmark (const juce::File& input);
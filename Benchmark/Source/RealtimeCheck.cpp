@@ -0,0 +1,337 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.cpp
+    Catches processBlock allocating, freeing or locking.
+
+    The hooks below replace the allocator and pthread_mutex_lock for the
+    whole benchmark, but they only record anything while a thread is inside
+    a RealtimeScope, so the rest of the app runs as normal.
+
+  ==============================================================================
+*/
+
+#include "RealtimeCheck.h"
+#include "../../Source/PluginProcessor.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#if JUCE_LINUX || JUCE_BSD
+ #include <dlfcn.h>
+ #include <pthread.h>
+#endif
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int maxBlockSize = 512;
+    constexpr int numChannels = 2;
+    constexpr int numBlocks = 4000;
+
+    // > 0 while this thread is standing in for the audio thread
+    thread_local int realtimeDepth = 0;
+
+    // set while a violation is being recorded, so its own allocations
+    // don't count
+    thread_local bool recording = false;
+
+    struct Violation
+    {
+        juce::String what;
+        juce::String backtrace;
+        int count;
+    };
+
+    std::vector<Violation>& getViolations()
+    {
+        static std::vector<Violation> violations;
+        return violations;
+    }
+
+    void recordViolation (const char* what) noexcept
+    {
+        if (realtimeDepth == 0 || recording)
+            return;
+
+        recording = true;
+
+        auto backtrace = juce::SystemStats::getStackBacktrace();
+        auto& violations = getViolations();
+        auto same = std::find_if (violations.begin(), violations.end(), [&] (const Violation& v)
+        {
+            return v.what == what && v.backtrace == backtrace;
+        });
+
+        if (same != violations.end())
+            ++same->count;
+        else
+            violations.push_back ({ what, backtrace, 1 });
+
+        recording = false;
+    }
+
+    /** Marks the calling thread as the audio thread while in scope. */
+    struct RealtimeScope
+    {
+        RealtimeScope() noexcept    { ++realtimeDepth; }
+        ~RealtimeScope() noexcept   { --realtimeDepth; }
+    };
+}
+
+//==============================================================================
+#if defined (__GLIBC__)
+
+// operator new and its aligned versions all end up in these, so hooking
+// them catches C and C++ allocations alike
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void __libc_free (void*);
+    void* __libc_memalign (size_t, size_t);
+
+    void* malloc (size_t size) noexcept
+    {
+        recordViolation ("malloc");
+        return __libc_malloc (size);
+    }
+
+    void* calloc (size_t count, size_t size) noexcept
+    {
+        recordViolation ("calloc");
+        return __libc_calloc (count, size);
+    }
+
+    void* realloc (void* pointer, size_t size) noexcept
+    {
+        recordViolation ("realloc");
+        return __libc_realloc (pointer, size);
+    }
+
+    void free (void* pointer) noexcept
+    {
+        if (pointer != nullptr)
+            recordViolation ("free");
+
+        __libc_free (pointer);
+    }
+
+    void* aligned_alloc (size_t alignment, size_t size) noexcept
+    {
+        recordViolation ("aligned_alloc");
+        return __libc_memalign (alignment, size);
+    }
+
+    int posix_memalign (void** result, size_t alignment, size_t size) noexcept
+    {
+        recordViolation ("posix_memalign");
+
+        if (alignment % sizeof (void*) != 0 || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+
+        auto* pointer = __libc_memalign (alignment, size);
+
+        if (pointer == nullptr && size != 0)
+            return ENOMEM;
+
+        *result = pointer;
+        return 0;
+    }
+}
+
+#else
+
+namespace
+{
+    // aligned blocks keep the pointer malloc returned just in front of them
+    void* allocateAligned (std::size_t size, std::size_t alignment)
+    {
+        auto* raw = static_cast<char*> (std::malloc (size + alignment + sizeof (void*)));
+
+        if (raw == nullptr)
+            throw std::bad_alloc();
+
+        auto address = reinterpret_cast<std::uintptr_t> (raw + sizeof (void*));
+        auto* aligned = reinterpret_cast<void**> ((address + alignment - 1) & ~(std::uintptr_t) (alignment - 1));
+        aligned[-1] = raw;
+        return aligned;
+    }
+
+    void freeAligned (void* pointer) noexcept
+    {
+        if (pointer != nullptr)
+            std::free (static_cast<void**> (pointer)[-1]);
+    }
+
+    void* allocate (std::size_t size)
+    {
+        if (auto* pointer = std::malloc (size == 0 ? 1 : size))
+            return pointer;
+
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new (std::size_t size)                                       { recordViolation ("operator new"); return allocate (size); }
+void* operator new[] (std::size_t size)                                     { recordViolation ("operator new[]"); return allocate (size); }
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept       { recordViolation ("operator new"); return std::malloc (size == 0 ? 1 : size); }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept     { recordViolation ("operator new[]"); return std::malloc (size == 0 ? 1 : size); }
+void* operator new (std::size_t size, std::align_val_t alignment)           { recordViolation ("operator new"); return allocateAligned (size, (std::size_t) alignment); }
+void* operator new[] (std::size_t size, std::align_val_t alignment)         { recordViolation ("operator new[]"); return allocateAligned (size, (std::size_t) alignment); }
+
+void operator delete (void* pointer) noexcept                               { if (pointer != nullptr) recordViolation ("operator delete"); std::free (pointer); }
+void operator delete[] (void* pointer) noexcept                             { if (pointer != nullptr) recordViolation ("operator delete[]"); std::free (pointer); }
+void operator delete (void* pointer, std::size_t) noexcept                  { operator delete (pointer); }
+void operator delete[] (void* pointer, std::size_t) noexcept                { operator delete[] (pointer); }
+void operator delete (void* pointer, std::align_val_t) noexcept             { if (pointer != nullptr) recordViolation ("operator delete"); freeAligned (pointer); }
+void operator delete[] (void* pointer, std::align_val_t) noexcept           { if (pointer != nullptr) recordViolation ("operator delete[]"); freeAligned (pointer); }
+void operator delete (void* pointer, std::size_t, std::align_val_t a) noexcept      { operator delete (pointer, a); }
+void operator delete[] (void* pointer, std::size_t, std::align_val_t a) noexcept    { operator delete[] (pointer, a); }
+
+#endif
+
+//==============================================================================
+#if JUCE_LINUX || JUCE_BSD
+
+// std::mutex, juce::CriticalSection and the rest all lock through this
+extern "C" int pthread_mutex_lock (pthread_mutex_t* mutex) noexcept
+{
+    using LockFunction = int (*) (pthread_mutex_t*);
+    static const auto next = reinterpret_cast<LockFunction> (dlsym (RTLD_NEXT, "pthread_mutex_lock"));
+
+    recordViolation ("pthread_mutex_lock");
+    return next (mutex);
+}
+
+#endif
+
+//==============================================================================
+namespace
+{
+    /** Stands in for a plugin wrapper, so anything that notifies the host
+        from processBlock goes down the same path it would in a DAW.
+    */
+    struct HostListener : public juce::AudioProcessorListener
+    {
+        void audioProcessorParameterChanged (juce::AudioProcessor*, int, float) override {}
+        void audioProcessorChanged (juce::AudioProcessor*, const ChangeDetails&) override {}
+    };
+
+    template <typename SampleType>
+    void playSession (PandamoniumAudioProcessor& processor, juce::Random& random)
+    {
+        using pandamonium::AutomatedParameter;
+
+        processor.setProcessingPrecision (std::is_same<SampleType, double>::value ? juce::AudioProcessor::doublePrecision
+                                                                                  : juce::AudioProcessor::singlePrecision);
+        processor.prepareToPlay (sampleRate, maxBlockSize);
+
+        juce::AudioBuffer<SampleType> buffer (numChannels, maxBlockSize);
+        juce::MidiBuffer midi;
+
+        // a few saved sessions to switch between, as a host recalling presets would
+        std::vector<juce::MemoryBlock> states;
+
+        for (auto mode : { 0.0f, 1.0f, 2.0f })
+        {
+            processor.setMode (mode);
+            processor.setOversampling (mode);
+            processor.setMix (100.0f - 30.0f * mode);
+            states.emplace_back();
+            processor.getStateInformation (states.back());
+        }
+
+        auto bypassed = false;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            // the message thread's turn: everything a user or host might do
+            // between two blocks
+            switch (random.nextInt (24))
+            {
+                case 0:     processor.setGain (random.nextFloat() * 24.0f); break;
+                case 1:     processor.setFuzz (random.nextFloat() * 30.0f); break;
+                case 2:     processor.setVolume (random.nextFloat() * 24.0f); break;
+                case 3:     processor.setMode ((float) random.nextInt (3)); break;
+                case 4:     processor.setMix (random.nextFloat() * 100.0f); break;
+                case 5:     processor.setOversampling ((float) random.nextInt (4)); break;
+                case 6:     processor.setOversamplingFilter ((float) random.nextInt (2)); break;
+                case 7:     processor.setAntialiasing ((float) random.nextInt (2)); break;
+                case 8:     processor.setNonRealtime (! processor.isNonRealtime()); break;
+                case 9:     processor.setBlackModeTable (random.nextBool() ? 0 : 256, pandamonium::Interpolation::Linear); break;
+                case 10:    bypassed = ! bypassed; break;
+                case 11:
+                {
+                    auto& state = states[(size_t) random.nextInt ((int) states.size())];
+                    processor.setStateInformation (state.getData(), (int) state.getSize());
+                    break;
+                }
+                default:    break;
+            }
+
+            // mostly noise, with runs of silence so the silent shortcut and
+            // the way back out of it both get exercised
+            auto numSamples = random.nextInt (4) == 0 ? 1 + random.nextInt (maxBlockSize) : maxBlockSize;
+            buffer.setSize (numChannels, numSamples, false, false, true);
+
+            if ((block / 50) % 4 == 3)
+            {
+                buffer.clear();
+            }
+            else
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    for (int i = 0; i < numSamples; ++i)
+                        buffer.setSample (channel, i, (SampleType) (random.nextFloat() * 2.0f - 1.0f));
+            }
+
+            RealtimeScope realtime;
+
+            for (int i = 0, numEvents = random.nextInt (8); i < numEvents; ++i)
+                processor.addParameterEvent (random.nextInt (numSamples), (AutomatedParameter) random.nextInt (pandamonium::numAutomatedParameters),
+                                             random.nextFloat() * 24.0f);
+
+            if (bypassed)
+                processor.processBlockBypassed (buffer, midi);
+            else
+                processor.processBlock (buffer, midi);
+        }
+
+        processor.setNonRealtime (false);
+        processor.releaseResources();
+    }
+}
+
+//==============================================================================
+bool runRealtimeCheck()
+{
+    PandamoniumAudioProcessor processor;
+    HostListener host;
+    processor.addListener (&host);
+    processor.setPlayConfigDetails (numChannels, numChannels, sampleRate, maxBlockSize);
+
+    juce::Random random (20211015);
+
+    std::cout << "float session, " << numBlocks << " blocks" << std::endl;
+    playSession<float> (processor, random);
+
+    std::cout << "double session, " << numBlocks << " blocks" << std::endl;
+    playSession<double> (processor, random);
+
+    processor.removeListener (&host);
+
+    auto& violations = getViolations();
+
+    for (auto& violation : violations)
+        std::cout << std::endl << "VIOLATION " << violation.what << " (" << violation.count << "x) from:" << std::endl
+                  << violation.backtrace << std::endl;
+
+    std::cout << std::endl << (violations.empty() ? "no allocations, frees or locks inside processBlock"
+                                                  : juce::String ((int) violations.size()) + " distinct violations")
+              << std::endl;
+
+    return violations.empty();
+}
@@ -0,0 +1,25 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.h
+    Catches processBlock allocating, freeing or locking.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/** Plays the processor through a long session on this thread: parameter
+    and mode changes, oversampling, anti-aliasing and offline switches,
+    Black mode tables, bypass, timestamped events, odd block sizes and
+    setStateInformation between blocks, in float and then in double.
+
+    While processBlock runs, every allocation, free and mutex lock this
+    thread makes is recorded with a stack trace. Allocations are caught
+    through malloc on glibc and through operator new elsewhere; mutexes
+    through pthread_mutex_lock on Linux and BSD only.
+
+    Prints each distinct violation with how often it happened and where it
+    came from. Returns false if there were any.
+*/
+bool runRealtimeCheck();
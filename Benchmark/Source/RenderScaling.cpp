@@ -0,0 +1,191 @@
+/*
+  ==============================================================================
+
+    RenderScaling.cpp
+    How the chunk-parallel renderer scales with threads.
+
+  ==============================================================================
+*/
+
+#include "RenderScaling.h"
+#include "../../Renderer/Source/ParallelRenderer.h"
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+    constexpr double lengthSeconds = 300.0;
+
+    struct Setup
+    {
+        const char* name;
+        const char* oversampling;
+        const char* filter;
+        const char* antialiasing;
+    };
+
+    const Setup setups[] =
+    {
+        { "no oversampling, ADAA",  "Off",  "Minimum Phase (IIR)",  "ADAA" },
+        { "4x IIR",                 "4x",   "Minimum Phase (IIR)",  "Off" },
+        { "2x FIR, ADAA",           "2x",   "Linear Phase (FIR)",   "ADAA" },
+        { "8x FIR",                 "8x",   "Linear Phase (FIR)",   "Off" },
+    };
+
+    /** Noise shaped into phrases of a few seconds, a gap of digital silence
+        after every fourth, written as 32-bit float.
+    */
+    bool writeTestFile (const juce::File& file)
+    {
+        file.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream (file.createOutputStream());
+
+        if (stream == nullptr)
+            return false;
+
+        std::unique_ptr<juce::AudioFormatWriter> writer (juce::WavAudioFormat().createWriterFor (stream.get(), sampleRate, numChannels,
+                                                                                                 32, {}, 0));
+
+        if (writer == nullptr)
+            return false;
+
+        stream.release();
+
+        juce::Random random (31337);
+        juce::AudioBuffer<float> buffer (numChannels, 4096);
+        const auto phraseLength = (juce::int64) (3.0 * sampleRate);
+        const auto totalLength = (juce::int64) (lengthSeconds * sampleRate);
+
+        for (juce::int64 position = 0; position < totalLength; position += buffer.getNumSamples())
+        {
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                auto phrase = (position + i) / phraseLength;
+                auto phase = (double) ((position + i) % phraseLength) / (double) phraseLength;
+                auto envelope = phrase % 5 == 4 ? 0.0f : (float) std::sin (juce::MathConstants<double>::pi * phase);
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    buffer.setSample (channel, i, envelope * 0.5f * (random.nextFloat() * 2.0f - 1.0f));
+            }
+
+            if (! writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples()))
+                return false;
+        }
+
+        return true;
+    }
+
+    /** The first sample at which a and b differ, or -1 if they don't. */
+    juce::int64 findFirstDifference (const juce::File& a, const juce::File& b)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> readerA (formats.createReaderFor (a));
+        std::unique_ptr<juce::AudioFormatReader> readerB (formats.createReaderFor (b));
+
+        if (readerA == nullptr || readerB == nullptr || readerA->numChannels != readerB->numChannels)
+            return 0;
+
+        if (readerA->lengthInSamples != readerB->lengthInSamples)
+            return juce::jmin (readerA->lengthInSamples, readerB->lengthInSamples);
+
+        const int blockSize = 65536;
+        juce::AudioBuffer<float> blockA ((int) readerA->numChannels, blockSize);
+        juce::AudioBuffer<float> blockB ((int) readerB->numChannels, blockSize);
+
+        for (juce::int64 position = 0; position < readerA->lengthInSamples; position += blockSize)
+        {
+            auto numSamples = (int) juce::jmin ((juce::int64) blockSize, readerA->lengthInSamples - position);
+            readerA->read (&blockA, 0, numSamples, position, true, true);
+            readerB->read (&blockB, 0, numSamples, position, true, true);
+
+            for (int channel = 0; channel < blockA.getNumChannels(); ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    if (blockA.getSample (channel, i) != blockB.getSample (channel, i))
+                        return position + i;
+        }
+
+        return -1;
+    }
+}
+
+//==============================================================================
+bool runRenderScaling (const juce::File& input)
+{
+    juce::TemporaryFile testFile (".wav");
+    auto source = input;
+
+    if (source == juce::File())
+    {
+        std::cout << "writing " << lengthSeconds << " s of test audio" << std::endl;
+
+        if (! writeTestFile (testFile.getFile()))
+        {
+            std::cout << "couldn't write " << testFile.getFile().getFullPathName() << std::endl;
+            return false;
+        }
+
+        source = testFile.getFile();
+    }
+
+    juce::Array<int> threadCounts;
+
+    for (int threads = 1; threads < juce::SystemStats::getNumCpus(); threads *= 2)
+        threadCounts.add (threads);
+
+    threadCounts.add (juce::SystemStats::getNumCpus());
+
+    auto allIdentical = true;
+
+    for (auto& setup : setups)
+    {
+        RenderSettings settings;
+        settings.bitsPerSample = 32;
+        settings.parameters.set ("mode", "2");
+        settings.parameters.set ("fuzz", "20");
+        settings.parameters.set ("oversampling", setup.oversampling);
+        settings.parameters.set ("oversamplingFilter", setup.filter);
+        settings.parameters.set ("antialiasing", setup.antialiasing);
+
+        // or High would render every setup at 8x with ADAA
+        settings.parameters.set ("offlineQuality", "Same as Realtime");
+
+        juce::TemporaryFile serialOutput (".wav");
+
+        auto start = juce::Time::getMillisecondCounterHiRes();
+        auto serial = renderFile (source, serialOutput.getFile(), settings);
+        auto serialSeconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+        std::cout << std::endl << setup.name << std::endl
+                  << "threads   seconds   speed-up   identical" << std::endl
+                  << "serial    " << juce::String (serialSeconds, 2).paddedRight (' ', 10) << "1.00" << std::endl;
+
+        if (serial.failed())
+        {
+            std::cout << serial.getErrorMessage() << std::endl;
+            return false;
+        }
+
+        for (auto threads : threadCounts)
+        {
+            juce::TemporaryFile parallelOutput (".wav");
+
+            start = juce::Time::getMillisecondCounterHiRes();
+            auto parallel = renderFileParallel (source, parallelOutput.getFile(), settings, threads);
+            auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+            auto difference = parallel.wasOk() ? findFirstDifference (serialOutput.getFile(), parallelOutput.getFile()) : 0;
+            allIdentical = allIdentical && difference < 0;
+
+            std::cout << juce::String (threads).paddedRight (' ', 10)
+                      << juce::String (seconds, 2).paddedRight (' ', 10)
+                      << juce::String (serialSeconds / seconds, 2).paddedRight (' ', 11)
+                      << (parallel.failed() ? parallel.getErrorMessage()
+                                            : difference < 0 ? juce::String ("yes") : "no, from sample " + juce::String (difference))
+                      << std::endl;
+        }
+    }
+
+    return allIdentical;
+}
@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    RenderScaling.h
+    How the chunk-parallel renderer scales with threads.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Renders input serially, then split across 1, 2, 4 ... threads up to one
+    per core, at a few settings with stateful oversampling and ADAA, and
+    prints the time and speed-up of each. Every split render has to come
+    out identical to the serial one, sample for sample.
+
+    Without an input file, five minutes of noise phrases with gaps of
+    silence between them are made up to render, so seams land in sound and
+    in silence alike. Returns false if any render differs or fails.
+*/
+bool runRenderScaling (const juce::File& input);
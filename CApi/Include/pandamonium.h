@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    pandamonium.h
+    A C interface to the fuzz, for calling it from other languages.
+
+    Everything goes through a pandamonium_fuzz handle, which holds the whole
+    state of one stream and nothing else: there are no globals to set up or
+    tear down, and handles never share anything mutable. Use a handle from
+    one thread at a time; it can move between threads freely, and different
+    handles can run on different threads at once.
+
+    Only pandamonium_create() and pandamonium_prepare() allocate. Every
+    other call is realtime safe, and the process calls work on the caller's
+    buffers in place.
+
+    Functions that can fail return a pandamonium_status. None of them ever
+    throws or aborts.
+
+  ==============================================================================
+*/
+
+#ifndef PANDAMONIUM_H
+#define PANDAMONIUM_H
+
+#if defined (_WIN32)
+ #if defined (PANDAMONIUM_BUILDING_LIBRARY)
+  #define PANDAMONIUM_API __declspec(dllexport)
+ #else
+  #define PANDAMONIUM_API __declspec(dllimport)
+ #endif
+#elif defined (__GNUC__) || defined (__clang__)
+ #define PANDAMONIUM_API __attribute__((visibility ("default")))
+#else
+ #define PANDAMONIUM_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Goes up whenever a change breaks callers built against an older
+    header. Compare it with pandamonium_abi_version() when loading.
+*/
+#define PANDAMONIUM_ABI_VERSION 1
+
+typedef struct pandamonium_fuzz pandamonium_fuzz;
+
+typedef enum pandamonium_status
+{
+    PANDAMONIUM_OK = 0,
+    PANDAMONIUM_INVALID_ARGUMENT = 1,   /* a null pointer, or a value out of range */
+    PANDAMONIUM_NOT_PREPARED = 2,       /* process before pandamonium_prepare() */
+    PANDAMONIUM_OUT_OF_MEMORY = 3
+} pandamonium_status;
+
+/** The plugin's parameters, in the plugin's units and ranges. */
+typedef enum pandamonium_parameter
+{
+    PANDAMONIUM_GAIN = 0,               /* input gain in dB, 0 - 24 (default 1) */
+    PANDAMONIUM_FUZZ = 1,               /* 0 - 30 (default 15) */
+    PANDAMONIUM_VOLUME = 2,             /* output volume in dB, 0 - 24 (default 1) */
+    PANDAMONIUM_MODE = 3,               /* 0 Black, 1 White, 2 Red (default 0) */
+    PANDAMONIUM_MIX = 4,                /* percent wet, 0 - 100 (default 100) */
+    PANDAMONIUM_OVERSAMPLING = 5,       /* 0 off, 1 2x, 2 4x, 3 8x (default 0) */
+    PANDAMONIUM_OVERSAMPLING_FILTER = 6,    /* 0 minimum phase IIR, 1 linear phase FIR (default 0) */
+    PANDAMONIUM_ANTIALIASING = 7        /* 0 off, 1 ADAA (default 0) */
+} pandamonium_parameter;
+
+/** PANDAMONIUM_ABI_VERSION as the library was built. */
+PANDAMONIUM_API int pandamonium_abi_version (void);
+
+/** A new handle with every parameter at its default, or null if out of
+    memory. It has to be prepared before it can process anything.
+*/
+PANDAMONIUM_API pandamonium_fuzz* pandamonium_create (void);
+
+/** Frees a handle. Null is fine. */
+PANDAMONIUM_API void pandamonium_destroy (pandamonium_fuzz* fuzz);
+
+/** Allocates for blocks of up to max_block_size frames of num_channels
+    channels at sample_rate, and starts from silence. Call again whenever
+    any of those change. Not realtime safe.
+*/
+PANDAMONIUM_API pandamonium_status pandamonium_prepare (pandamonium_fuzz* fuzz, double sample_rate,
+                                                        int max_block_size, int num_channels);
+
+/** Forgets the stream so far, as if just prepared, keeping the parameters. */
+PANDAMONIUM_API pandamonium_status pandamonium_reset (pandamonium_fuzz* fuzz);
+
+/** Sets a parameter. Gain, volume and mix ramp to their new values over
+    20 ms; everything else changes at the start of the next process call.
+    Changing the oversampling clears its filters and changes the latency.
+*/
+PANDAMONIUM_API pandamonium_status pandamonium_set_parameter (pandamonium_fuzz* fuzz, pandamonium_parameter parameter,
+                                                              double value);
+
+/** The value a parameter was last set to, in *value. */
+PANDAMONIUM_API pandamonium_status pandamonium_get_parameter (const pandamonium_fuzz* fuzz, pandamonium_parameter parameter,
+                                                              double* value);
+
+/** How many frames the output lags the input by, which depends on the
+    oversampling. 0 before pandamonium_prepare().
+*/
+PANDAMONIUM_API int pandamonium_get_latency (const pandamonium_fuzz* fuzz);
+
+/** Processes num_frames frames in place, one buffer per channel. Any
+    number of frames is fine; more than max_block_size are taken a block
+    at a time. num_channels can be fewer than were prepared, not more.
+*/
+PANDAMONIUM_API pandamonium_status pandamonium_process_planar (pandamonium_fuzz* fuzz, float* const* channels,
+                                                               int num_channels, int num_frames);
+
+/** As pandamonium_process_planar(), with the channels interleaved in one
+    buffer. The fuzz runs a channel at a time, so each block is spread out
+    into the handle's own planar buffers and back, which costs a copy each
+    way that pandamonium_process_planar() doesn't.
+*/
+PANDAMONIUM_API pandamonium_status pandamonium_process_interleaved (pandamonium_fuzz* fuzz, float* samples,
+                                                                    int num_channels, int num_frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PANDAMONIUM_H */
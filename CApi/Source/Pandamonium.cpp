@@ -0,0 +1,212 @@
+/*
+  ==============================================================================
+
+    Pandamonium.cpp
+    The C interface in pandamonium.h, over pandamonium::FuzzProcessor.
+
+  ==============================================================================
+*/
+
+#include "pandamonium.h"
+
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <vector>
+
+#include "FuzzProcessor.h"
+
+namespace
+{
+    /** A parameter's range and default, as in the plugin. */
+    struct ParameterInfo
+    {
+        double minimum, maximum, defaultValue;
+        bool whole;     // only whole numbers
+    };
+
+    constexpr ParameterInfo parameterInfo[] = {
+        { 0.0, 24.0, 1.0, false },      // gain
+        { 0.0, 30.0, 15.0, false },     // fuzz
+        { 0.0, 24.0, 1.0, false },      // volume
+        { 0.0, 2.0, 0.0, true },        // mode
+        { 0.0, 100.0, 100.0, false },   // mix
+        { 0.0, 3.0, 0.0, true },        // oversampling
+        { 0.0, 1.0, 0.0, true },        // oversampling filter
+        { 0.0, 1.0, 0.0, true }         // antialiasing
+    };
+
+    constexpr int numParameters = (int) (sizeof (parameterInfo) / sizeof (parameterInfo[0]));
+
+    bool isValid (pandamonium_parameter parameter, double value)
+    {
+        if ((int) parameter < 0 || (int) parameter >= numParameters || ! std::isfinite (value))
+            return false;
+
+        auto& info = parameterInfo[(int) parameter];
+        return value >= info.minimum && value <= info.maximum && (! info.whole || value == std::floor (value));
+    }
+}
+
+//==============================================================================
+/** Everything one stream needs, so handles never share anything but the
+    kernel tables, which are built once and only ever read.
+*/
+struct pandamonium_fuzz
+{
+    pandamonium_fuzz()
+    {
+        for (int i = 0; i < numParameters; ++i)
+            values[i] = parameterInfo[i].defaultValue;
+
+        update();
+    }
+
+    /** Hands the current values to the processor. */
+    void update() noexcept
+    {
+        processor.setParameters (pandamonium::FuzzParameters::fromRaw ((float) values[PANDAMONIUM_GAIN], (float) values[PANDAMONIUM_FUZZ],
+                                                                       (float) values[PANDAMONIUM_VOLUME], (float) values[PANDAMONIUM_MODE],
+                                                                       (float) values[PANDAMONIUM_MIX]));
+        processor.setOversampling ((int) values[PANDAMONIUM_OVERSAMPLING],
+                                   (pandamonium::OversamplingFilter) (int) values[PANDAMONIUM_OVERSAMPLING_FILTER]);
+        processor.setAntialiasing (values[PANDAMONIUM_ANTIALIASING] != 0.0);
+    }
+
+    pandamonium::FuzzProcessor<float> processor;
+    double values[numParameters];
+
+    int maxBlockSize = 0;
+    int numChannels = 0;
+
+    // for pandamonium_process_interleaved, which the processor can't take
+    // as it is
+    std::vector<float> planar;
+    std::vector<float*> planarChannels;
+};
+
+//==============================================================================
+int pandamonium_abi_version (void)
+{
+    return PANDAMONIUM_ABI_VERSION;
+}
+
+pandamonium_fuzz* pandamonium_create (void)
+{
+    return new (std::nothrow) pandamonium_fuzz();
+}
+
+void pandamonium_destroy (pandamonium_fuzz* fuzz)
+{
+    delete fuzz;
+}
+
+pandamonium_status pandamonium_prepare (pandamonium_fuzz* fuzz, double sampleRate, int maxBlockSize, int numChannels)
+{
+    if (fuzz == nullptr || ! (sampleRate > 0.0) || ! std::isfinite (sampleRate) || maxBlockSize <= 0 || numChannels <= 0)
+        return PANDAMONIUM_INVALID_ARGUMENT;
+
+    try
+    {
+        fuzz->processor.prepare (sampleRate, maxBlockSize, numChannels);
+        fuzz->planar.assign ((size_t) maxBlockSize * (size_t) numChannels, 0.0f);
+        fuzz->planarChannels.resize ((size_t) numChannels);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            fuzz->planarChannels[(size_t) channel] = fuzz->planar.data() + (size_t) channel * (size_t) maxBlockSize;
+    }
+    catch (const std::bad_alloc&)
+    {
+        fuzz->processor.release();
+        fuzz->maxBlockSize = fuzz->numChannels = 0;
+        return PANDAMONIUM_OUT_OF_MEMORY;
+    }
+
+    fuzz->maxBlockSize = maxBlockSize;
+    fuzz->numChannels = numChannels;
+    return PANDAMONIUM_OK;
+}
+
+pandamonium_status pandamonium_reset (pandamonium_fuzz* fuzz)
+{
+    if (fuzz == nullptr)
+        return PANDAMONIUM_INVALID_ARGUMENT;
+
+    fuzz->processor.reset();
+    return PANDAMONIUM_OK;
+}
+
+pandamonium_status pandamonium_set_parameter (pandamonium_fuzz* fuzz, pandamonium_parameter parameter, double value)
+{
+    if (fuzz == nullptr || ! isValid (parameter, value))
+        return PANDAMONIUM_INVALID_ARGUMENT;
+
+    fuzz->values[parameter] = value;
+    fuzz->update();
+    return PANDAMONIUM_OK;
+}
+
+pandamonium_status pandamonium_get_parameter (const pandamonium_fuzz* fuzz, pandamonium_parameter parameter, double* value)
+{
+    if (fuzz == nullptr || value == nullptr || (int) parameter < 0 || (int) parameter >= numParameters)
+        return PANDAMONIUM_INVALID_ARGUMENT;
+
+    *value = fuzz->values[parameter];
+    return PANDAMONIUM_OK;
+}
+
+int pandamonium_get_latency (const pandamonium_fuzz* fuzz)
+{
+    return fuzz != nullptr ? fuzz->processor.getLatencySamples() : 0;
+}
+
+pandamonium_status pandamonium_process_planar (pandamonium_fuzz* fuzz, float* const* channels, int numChannels, int numFrames)
+{
+    if (fuzz == nullptr || channels == nullptr || numChannels < 0 || numFrames < 0)
+        return PANDAMONIUM_INVALID_ARGUMENT;
+
+    if (fuzz->maxBlockSize == 0)
+        return PANDAMONIUM_NOT_PREPARED;
+
+    if (numChannels > fuzz->numChannels)
+        return PANDAMONIUM_INVALID_ARGUMENT;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        if (channels[channel] == nullptr)
+            return PANDAMONIUM_INVALID_ARGUMENT;
+
+    fuzz->processor.process (channels, numChannels, numFrames);
+    return PANDAMONIUM_OK;
+}
+
+pandamonium_status pandamonium_process_interleaved (pandamonium_fuzz* fuzz, float* samples, int numChannels, int numFrames)
+{
+    if (fuzz == nullptr || samples == nullptr || numChannels < 0 || numFrames < 0)
+        return PANDAMONIUM_INVALID_ARGUMENT;
+
+    if (fuzz->maxBlockSize == 0)
+        return PANDAMONIUM_NOT_PREPARED;
+
+    if (numChannels > fuzz->numChannels)
+        return PANDAMONIUM_INVALID_ARGUMENT;
+
+    auto* const* planar = fuzz->planarChannels.data();
+
+    for (int start = 0; start < numFrames; start += fuzz->maxBlockSize)
+    {
+        auto length = std::min (fuzz->maxBlockSize, numFrames - start);
+        auto* frames = samples + (size_t) start * (size_t) numChannels;
+
+        for (int i = 0; i < length; ++i)
+            for (int channel = 0; channel < numChannels; ++channel)
+                planar[channel][i] = frames[(size_t) i * (size_t) numChannels + (size_t) channel];
+
+        fuzz->processor.process (planar, numChannels, length);
+
+        for (int i = 0; i < length; ++i)
+            for (int channel = 0; channel < numChannels; ++channel)
+                frames[(size_t) i * (size_t) numChannels + (size_t) channel] = planar[channel][i];
+    }
+
+    return PANDAMONIUM_OK;
+}
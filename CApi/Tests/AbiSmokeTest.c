@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    AbiSmokeTest.c
+    Drives libpandamonium from plain C99, the way another language would.
+
+  ==============================================================================
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#if ! defined (_WIN32)
+ #include <pthread.h>
+#endif
+
+#include "pandamonium.h"
+
+#define NUM_FRAMES 10000
+#define NUM_THREADS 8
+
+static int numFailures = 0;
+
+#define EXPECT(condition) \
+    do { if (! (condition)) { printf ("FAILED: %s (line %d)\n", #condition, __LINE__); ++numFailures; } } while (0)
+
+static void fill (float* left, float* right, float* interleaved)
+{
+    int i;
+
+    for (i = 0; i < NUM_FRAMES; ++i)
+    {
+        left[i] = 0.5f * sinf ((float) i * 0.03f);
+        right[i] = 0.3f * sinf ((float) i * 0.011f);
+        interleaved[2 * i] = left[i];
+        interleaved[2 * i + 1] = right[i];
+    }
+}
+
+/* 4x minimum phase oversampling, Red, with ADAA */
+static pandamonium_fuzz* createConfigured (void)
+{
+    pandamonium_fuzz* fuzz = pandamonium_create();
+
+    if (fuzz == NULL
+         || pandamonium_prepare (fuzz, 48000.0, 300, 2) != PANDAMONIUM_OK
+         || pandamonium_set_parameter (fuzz, PANDAMONIUM_OVERSAMPLING, 2.0) != PANDAMONIUM_OK
+         || pandamonium_set_parameter (fuzz, PANDAMONIUM_MODE, 2.0) != PANDAMONIUM_OK
+         || pandamonium_set_parameter (fuzz, PANDAMONIUM_ANTIALIASING, 1.0) != PANDAMONIUM_OK)
+    {
+        pandamonium_destroy (fuzz);
+        return NULL;
+    }
+
+    return fuzz;
+}
+
+static void testErrors (void)
+{
+    static float left[NUM_FRAMES], right[NUM_FRAMES];
+    float* channels[2];
+    double value = -1.0;
+    pandamonium_fuzz* fuzz = pandamonium_create();
+
+    channels[0] = left;
+    channels[1] = right;
+
+    EXPECT (fuzz != NULL);
+    EXPECT (pandamonium_process_planar (fuzz, channels, 2, NUM_FRAMES) == PANDAMONIUM_NOT_PREPARED);
+    EXPECT (pandamonium_process_interleaved (fuzz, left, 2, 10) == PANDAMONIUM_NOT_PREPARED);
+    EXPECT (pandamonium_get_latency (fuzz) == 0);
+
+    EXPECT (pandamonium_prepare (fuzz, 0.0, 512, 2) == PANDAMONIUM_INVALID_ARGUMENT);
+    EXPECT (pandamonium_prepare (fuzz, 48000.0, 0, 2) == PANDAMONIUM_INVALID_ARGUMENT);
+    EXPECT (pandamonium_prepare (fuzz, 48000.0, 512, 0) == PANDAMONIUM_INVALID_ARGUMENT);
+    EXPECT (pandamonium_prepare (NULL, 48000.0, 512, 2) == PANDAMONIUM_INVALID_ARGUMENT);
+
+    EXPECT (pandamonium_set_parameter (fuzz, PANDAMONIUM_MODE, 1.5) == PANDAMONIUM_INVALID_ARGUMENT);
+    EXPECT (pandamonium_set_parameter (fuzz, PANDAMONIUM_GAIN, 25.0) == PANDAMONIUM_INVALID_ARGUMENT);
+    EXPECT (pandamonium_set_parameter (fuzz, PANDAMONIUM_GAIN, NAN) == PANDAMONIUM_INVALID_ARGUMENT);
+    EXPECT (pandamonium_set_parameter (fuzz, (pandamonium_parameter) 8, 0.0) == PANDAMONIUM_INVALID_ARGUMENT);
+
+    EXPECT (pandamonium_get_parameter (fuzz, PANDAMONIUM_FUZZ, &value) == PANDAMONIUM_OK && value == 15.0);
+    EXPECT (pandamonium_get_parameter (fuzz, PANDAMONIUM_FUZZ, NULL) == PANDAMONIUM_INVALID_ARGUMENT);
+
+    EXPECT (pandamonium_prepare (fuzz, 48000.0, 512, 1) == PANDAMONIUM_OK);
+    EXPECT (pandamonium_process_planar (fuzz, channels, 2, NUM_FRAMES) == PANDAMONIUM_INVALID_ARGUMENT);
+    EXPECT (pandamonium_process_planar (fuzz, NULL, 1, NUM_FRAMES) == PANDAMONIUM_INVALID_ARGUMENT);
+
+    pandamonium_destroy (fuzz);
+    pandamonium_destroy (NULL);
+}
+
+/* what every handle should make of the test signal, set by testProcessing() */
+static float expectedLeft[NUM_FRAMES];
+
+static void testProcessing (void)
+{
+    static float left[NUM_FRAMES], right[NUM_FRAMES], interleaved[2 * NUM_FRAMES];
+    float* channels[2];
+    double energy = 0.0;
+    int i, same = 1;
+    pandamonium_fuzz* fuzz = createConfigured();
+
+    channels[0] = left;
+    channels[1] = right;
+
+    EXPECT (fuzz != NULL);
+
+    if (fuzz == NULL)
+        return;
+
+    EXPECT (pandamonium_get_latency (fuzz) == 6);
+
+    fill (left, right, interleaved);
+    EXPECT (pandamonium_process_planar (fuzz, channels, 2, NUM_FRAMES) == PANDAMONIUM_OK);
+    memcpy (expectedLeft, left, sizeof (left));
+
+    /* the same stream again, interleaved this time */
+    EXPECT (pandamonium_reset (fuzz) == PANDAMONIUM_OK);
+    EXPECT (pandamonium_process_interleaved (fuzz, interleaved, 2, NUM_FRAMES) == PANDAMONIUM_OK);
+
+    for (i = 0; i < NUM_FRAMES; ++i)
+    {
+        same &= interleaved[2 * i] == left[i] && interleaved[2 * i + 1] == right[i];
+        energy += left[i] * left[i];
+    }
+
+    EXPECT (same);
+    EXPECT (energy > 1.0);
+
+    pandamonium_destroy (fuzz);
+}
+
+#if ! defined (_WIN32)
+static void* renderOnThread (void* result)
+{
+    static float unused[2 * NUM_FRAMES];
+    float left[NUM_FRAMES], right[NUM_FRAMES];
+    float* channels[2];
+    int pass;
+    pandamonium_fuzz* fuzz = createConfigured();
+
+    channels[0] = left;
+    channels[1] = right;
+    *(int*) result = fuzz != NULL;
+
+    for (pass = 0; fuzz != NULL && pass < 20; ++pass)
+    {
+        fill (left, right, unused);
+        pandamonium_reset (fuzz);
+        pandamonium_process_planar (fuzz, channels, 2, NUM_FRAMES);
+
+        if (memcmp (left, expectedLeft, sizeof (left)) != 0)
+            *(int*) result = 0;
+    }
+
+    pandamonium_destroy (fuzz);
+    return NULL;
+}
+
+/* handles share nothing, so one per thread gives the same output as one alone */
+static void testThreads (void)
+{
+    pthread_t threads[NUM_THREADS];
+    int results[NUM_THREADS];
+    int i;
+
+    for (i = 0; i < NUM_THREADS; ++i)
+        EXPECT (pthread_create (&threads[i], NULL, renderOnThread, &results[i]) == 0);
+
+    for (i = 0; i < NUM_THREADS; ++i)
+    {
+        pthread_join (threads[i], NULL);
+        EXPECT (results[i]);
+    }
+}
+#endif
+
+int main (void)
+{
+    EXPECT (pandamonium_abi_version() == PANDAMONIUM_ABI_VERSION);
+
+    testErrors();
+    testProcessing();
+
+   #if ! defined (_WIN32)
+    testThreads();
+   #endif
+
+    if (numFailures > 0)
+    {
+        printf ("%d checks failed\n", numFailures);
+        return 1;
+    }
+
+    printf ("all passed\n");
+    return 0;
+}
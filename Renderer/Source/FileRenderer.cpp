@@ -0,0 +1,234 @@
+/*
+  ==============================================================================
+
+    FileRenderer.cpp
+    Runs audio through PandamoniumAudioProcessor offline.
+
+  ==============================================================================
+*/
+
+#include "FileRenderer.h"
+
+namespace
+{
+    // about 22 s at 48 kHz of input mapped at once
+    constexpr juce::int64 mappedWindowSamples = 1 << 20;
+
+    // output goes to disk in writes this big
+    constexpr size_t outputBufferSize = 1 << 22;
+
+    /** The bit depth closest to wanted that format can write, preferring
+        more bits over fewer.
+    */
+    int chooseBitDepth (juce::AudioFormat& format, int wanted)
+    {
+        auto depths = format.getPossibleBitDepths();
+
+        if (depths.isEmpty() || depths.contains (wanted))
+            return wanted;
+
+        for (auto depth : depths)
+            if (depth > wanted)
+                return depth;
+
+        return depths.getLast();
+    }
+}
+
+//==============================================================================
+OfflineFuzz::OfflineFuzz (const RenderSettings& settings)
+    : _blockSize (juce::jmax (1, settings.blockSize))
+{
+    if (settings.preset.getSize() > 0)
+        _processor.setStateInformation (settings.preset.getData(), (int) settings.preset.getSize());
+
+    for (auto* parameter : _processor.getParameters())
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (parameter))
+            if (settings.parameters.containsKey (withID->paramID))
+                parameter->setValueNotifyingHost (parameter->getValueForText (settings.parameters[withID->paramID]));
+
+    _processor.setNonRealtime (true);
+}
+
+juce::Result OfflineFuzz::prepare (double sampleRate, int numChannels)
+{
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add (juce::AudioChannelSet::canonicalChannelSet (numChannels));
+    layout.outputBuses.add (juce::AudioChannelSet::canonicalChannelSet (numChannels));
+
+    if (numChannels <= 0 || ! _processor.setBusesLayout (layout))
+        return juce::Result::fail (juce::String (numChannels) + " channels isn't a layout the plugin supports");
+
+    _processor.setRateAndBufferSizeDetails (sampleRate, _blockSize);
+    _processor.prepareToPlay (sampleRate, _blockSize);
+    return juce::Result::ok();
+}
+
+int OfflineFuzz::getLatencySamples() const
+{
+    return _processor.getProcessingLatencySamples();
+}
+
+int OfflineFuzz::getTailLengthSamples() const
+{
+    return _processor.getTailLengthSamples();
+}
+
+float OfflineFuzz::getSilenceThreshold()
+{
+    auto params = pandamonium::FuzzParameters::fromRaw (_processor.getGain(), _processor.getFuzz(), _processor.getVolume(),
+                                                        _processor.getMode(), _processor.getMix());
+
+    return pandamonium::getSilenceThreshold (params.mode, params.fuzz, params.gain, params.volume, params.mix);
+}
+
+void OfflineFuzz::process (juce::AudioBuffer<float>& buffer)
+{
+    _processor.processBlock (buffer, _midi);
+}
+
+std::unique_ptr<juce::XmlElement> OfflineFuzz::getState()
+{
+    juce::MemoryBlock state;
+    _processor.getStateInformation (state);
+    return juce::AudioProcessor::getXmlFromBinary (state.getData(), (int) state.getSize());
+}
+
+//==============================================================================
+std::unique_ptr<juce::AudioFormatReader> openReader (juce::AudioFormatManager& formats, const juce::File& input,
+                                                     const RenderSettings& settings)
+{
+    if (settings.memoryMapped)
+        if (auto* format = formats.findFormatForFileExtension (input.getFileExtension()))
+            if (auto* mapped = format->createMemoryMappedReader (input))
+                return std::unique_ptr<juce::AudioFormatReader> (mapped);
+
+    return std::unique_ptr<juce::AudioFormatReader> (formats.createReaderFor (input));
+}
+
+bool readBlock (juce::AudioFormatReader& reader, juce::AudioBuffer<float>& buffer, juce::int64 position, int numSamples)
+{
+    if (auto* mapped = dynamic_cast<juce::MemoryMappedAudioFormatReader*> (&reader))
+    {
+        auto wanted = juce::Range<juce::int64> (position, position + numSamples).getIntersectionWith ({ 0, reader.lengthInSamples });
+        auto section = mapped->getMappedSection();
+
+        if (! wanted.isEmpty() && ! section.contains (wanted))
+        {
+            auto window = juce::jmax (mappedWindowSamples, (juce::int64) numSamples);
+
+            // walking backwards, as a warm-up does, the window ends here instead
+            auto start = wanted.getStart() < section.getStart() ? wanted.getEnd() - window : wanted.getStart();
+            start = juce::jmax ((juce::int64) 0, start);
+
+            if (! mapped->mapSectionOfFile ({ start, juce::jmin (start + window, reader.lengthInSamples) }))
+                return false;
+        }
+    }
+
+    return reader.read (&buffer, 0, numSamples, position, true, true);
+}
+
+//==============================================================================
+juce::Result renderStream (juce::AudioFormatReader& reader, juce::AudioFormatWriter& writer, const RenderSettings& settings)
+{
+    auto numChannels = (int) reader.numChannels;
+    OfflineFuzz fuzz (settings);
+    auto prepared = fuzz.prepare (reader.sampleRate, numChannels);
+
+    if (prepared.failed())
+        return prepared;
+
+    const auto blockSize = juce::jmax (1, settings.blockSize);
+    const auto latency = (juce::int64) fuzz.getLatencySamples();
+    const auto length = reader.lengthInSamples;
+
+    juce::AudioBuffer<float> buffer (numChannels, blockSize);
+
+    // run on for the latency past the end, reading silence, so the last
+    // input sample makes it out
+    for (juce::int64 position = 0; position < length + latency; position += blockSize)
+    {
+        auto numSamples = (int) juce::jmin ((juce::int64) blockSize, length + latency - position);
+        buffer.setSize (numChannels, numSamples, false, false, true);
+
+        if (! readBlock (reader, buffer, position, numSamples))
+            return juce::Result::fail ("couldn't read from the input");
+
+        fuzz.process (buffer);
+
+        // the first latency samples out come from before the input started
+        auto skip = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numSamples, latency - position);
+
+        if (skip < numSamples && ! writer.writeFromAudioSampleBuffer (buffer, skip, numSamples - skip))
+            return juce::Result::fail ("couldn't write to the output");
+    }
+
+    return juce::Result::ok();
+}
+
+juce::Result renderFile (const juce::File& input, const juce::File& output, const RenderSettings& settings)
+{
+    return renderFile (input, output, settings, [&settings] (juce::AudioFormatReader& reader, juce::AudioFormatWriter& writer)
+    {
+        return renderStream (reader, writer, settings);
+    });
+}
+
+juce::Result renderFile (const juce::File& input, const juce::File& output, const RenderSettings& settings,
+                         const RenderFunction& render)
+{
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    auto reader = openReader (formats, input, settings);
+
+    if (reader == nullptr)
+        return juce::Result::fail ("couldn't open " + input.getFullPathName() + " as audio");
+
+    auto* format = formats.findFormatForFileExtension (output.getFileExtension());
+
+    if (format == nullptr || ! format->canDoStereo())
+        return juce::Result::fail ("can't write " + output.getFileExtension() + " files");
+
+    auto bits = chooseBitDepth (*format, settings.bitsPerSample > 0 ? settings.bitsPerSample : (int) reader->bitsPerSample);
+
+    juce::TemporaryFile temporary (output);
+    std::unique_ptr<juce::OutputStream> stream (temporary.getFile().createOutputStream (outputBufferSize));
+
+    if (stream == nullptr)
+        return juce::Result::fail ("couldn't create " + output.getFullPathName());
+
+    // quality option 0 is the fastest, and every option of the lossless
+    // formats is lossless
+    std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor (stream.get(), reader->sampleRate, reader->numChannels,
+                                                                              bits, reader->metadataValues, 0));
+
+    if (writer == nullptr)
+        return juce::Result::fail ("can't write " + juce::String (reader->numChannels) + " channels of "
+                                   + juce::String (bits) + " bit audio as " + format->getFormatName());
+
+    stream.release();   // the writer owns it now
+
+    auto result = render (*reader, *writer);
+
+    // deleting the writer finishes the header and closes the file
+    writer.reset();
+
+    if (result.wasOk() && ! temporary.overwriteTargetFileWithTemporary())
+        return juce::Result::fail ("couldn't replace " + output.getFullPathName());
+
+    return result;
+}
+
+juce::MemoryBlock loadPreset (const juce::File& file)
+{
+    juce::MemoryBlock preset;
+
+    if (auto xml = juce::parseXML (file))
+        juce::AudioProcessor::copyXmlToBinary (*xml, preset);
+    else
+        file.loadFileAsData (preset);
+
+    return preset;
+}
@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    FileRenderer.h
+    Runs audio through PandamoniumAudioProcessor offline.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+//==============================================================================
+/** How every file in a batch is processed. */
+struct RenderSettings
+{
+    juce::MemoryBlock preset;           // a state saved by the plugin, applied first if not empty
+    juce::StringPairArray parameters;   // parameter ID -> value as the plugin would display it
+    int blockSize = 4096;
+    int bitsPerSample = 0;              // 0 keeps the input's
+    bool memoryMapped = true;           // map WAV and AIFF input rather than reading it through a stream
+};
+
+//==============================================================================
+/**
+    One processor set up for offline rendering: the preset and parameters
+    from a RenderSettings applied, non-realtime so Offline Quality takes
+    effect, and prepared for one sample rate and channel count.
+*/
+class OfflineFuzz
+{
+public:
+    explicit OfflineFuzz (const RenderSettings& settings);
+
+    /** Fails if the channel count isn't one the plugin supports. */
+    juce::Result prepare (double sampleRate, int numChannels);
+
+    /** How many samples late the output is. */
+    int getLatencySamples() const;
+
+    /** How long the output rings on after the input stops. */
+    int getTailLengthSamples() const;
+
+    /** An input block whose peak is at most this in every channel counts as
+        silent, and processBlock may skip it.
+    */
+    float getSilenceThreshold();
+
+    /** Processes up to the settings' block size of samples in place. */
+    void process (juce::AudioBuffer<float>& buffer);
+
+    /** The plugin state with the settings applied, as a preset file holds it. */
+    std::unique_ptr<juce::XmlElement> getState();
+
+private:
+    PandamoniumAudioProcessor _processor;
+    juce::MidiBuffer _midi;
+    int _blockSize;
+};
+
+//==============================================================================
+/** Opens input for reading: memory-mapped if settings ask for it and its
+    format can be (WAV and AIFF), otherwise as a stream. Returns nullptr if
+    it isn't audio formats knows.
+*/
+std::unique_ptr<juce::AudioFormatReader> openReader (juce::AudioFormatManager& formats, const juce::File& input,
+                                                     const RenderSettings& settings);
+
+/** Reads numSamples from position into the start of buffer, with silence
+    past the end of the input.
+
+    A memory-mapped reader only has a window of the file mapped at a time,
+    so what's resident stays the same size however big the file is; this
+    moves the window along first when it has to.
+*/
+bool readBlock (juce::AudioFormatReader& reader, juce::AudioBuffer<float>& buffer, juce::int64 position, int numSamples);
+
+//==============================================================================
+/** Streams everything reader has through an OfflineFuzz into writer, a
+    block at a time, so memory use doesn't depend on the length. The output
+    is shifted back by the latency, so it lines up with the input and is
+    exactly as long.
+*/
+juce::Result renderStream (juce::AudioFormatReader& reader, juce::AudioFormatWriter& writer, const RenderSettings& settings);
+
+/** Renders input into output, in whatever format output's extension names.
+    The result goes to a temporary file first and only replaces output once
+    it's complete.
+*/
+juce::Result renderFile (const juce::File& input, const juce::File& output, const RenderSettings& settings);
+
+/** What renderFile does once the files are open: by default renderStream. */
+using RenderFunction = std::function<juce::Result (juce::AudioFormatReader& reader, juce::AudioFormatWriter& writer)>;
+
+/** renderFile, with render doing the work in between. */
+juce::Result renderFile (const juce::File& input, const juce::File& output, const RenderSettings& settings,
+                         const RenderFunction& render);
+
+/** Reads a preset saved as XML, or as the binary the plugin stores in a
+    session. Returns an empty block if the file can't be read.
+*/
+juce::MemoryBlock loadPreset (const juce::File& file);
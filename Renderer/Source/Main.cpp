@@ -0,0 +1,338 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Batch renderer: runs audio files through PandamoniumAudioProcessor.
+
+    PandamoniumRender [options] files or folders...
+
+    Each input is written as <name><suffix>.<extension>, next to it or in
+    --output-dir, in the same format unless --format says otherwise. Files
+    render concurrently on a fixed pool of --jobs threads (one per core by
+    default), each streaming a block at a time, so memory use depends on
+    the number of jobs and not on how long the files are. A single file is
+    split into chunks rendered on all the threads instead, with the same
+    result as rendering it in one go.
+
+    PandamoniumRender --pipe [options] < input > output
+
+    Filters one stream from stdin to stdout instead, as WAV or raw PCM, so
+    it can sit between ffmpeg or sox and whatever comes next. Messages go
+    to stderr.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "FileRenderer.h"
+#include "ParallelRenderer.h"
+#include "PcmPipe.h"
+
+namespace
+{
+    const juce::StringArray audioExtensions { ".wav", ".flac", ".aif", ".aiff" };
+    const juce::StringArray modeNames { "black", "white", "red" };
+
+    void printUsage (PandamoniumAudioProcessor& processor)
+    {
+        std::cout << "usage: PandamoniumRender [options] files or folders..." << std::endl
+                  << std::endl
+                  << "  --output-dir=folder     where to write (default: next to each input)" << std::endl
+                  << "  --suffix=text           added to each output name (default: -fuzz)" << std::endl
+                  << "  --format=extension      wav, flac or aiff (default: the input's)" << std::endl
+                  << "  --bits=n                bit depth of the output (default: the input's)" << std::endl
+                  << "  --preset=file           a preset saved from the plugin, XML or binary" << std::endl
+                  << "  --save-preset=file      write the preset with the options below applied as XML" << std::endl
+                  << "  --jobs=n                threads to render on (default: "
+                  << juce::SystemStats::getNumCpus() << ")" << std::endl
+                  << "  --block-size=n          samples per processBlock (default: 4096)" << std::endl
+                  << "  --no-mmap               read WAV and AIFF through a stream, not a memory map" << std::endl
+                  << std::endl
+                  << "  --pipe                  filter stdin to stdout instead of rendering files" << std::endl
+                  << "  --input-format=f        wav, f32, s16, s24 or s32 (default: wav)" << std::endl
+                  << "  --output-format=f       as above, or wav:s16, wav:s24 or wav:s32 for integer WAV" << std::endl
+                  << "                          (default: wav, which is float, if the input is, else f32)" << std::endl
+                  << "  --channels=n            channels in a raw input (default: 2)" << std::endl
+                  << "  --rate=hz               sample rate of a raw input (default: 48000)" << std::endl
+                  << std::endl
+                  << "parameters, applied over the preset:" << std::endl;
+
+        for (auto* parameter : processor.getParameters())
+        {
+            auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (parameter);
+
+            if (withID == nullptr)
+                continue;
+
+            auto choices = withID->paramID == "mode" ? modeNames : parameter->getAllValueStrings();
+            std::cout << "  --" << withID->paramID.paddedRight (' ', 22) << withID->name;
+
+            if (! choices.isEmpty())
+                std::cout << " (" << choices.joinIntoString (", ") << ")";
+
+            std::cout << std::endl;
+        }
+    }
+
+    /** The value to give a parameter for an option's text, in the form
+        getValueForText takes. Choices can be given by name or index, and
+        the mode by name, in any case.
+    */
+    juce::String parseParameterValue (juce::AudioProcessorParameter& parameter, const juce::String& paramID, const juce::String& text)
+    {
+        if (paramID == "mode" && modeNames.contains (text, true))
+            return juce::String (modeNames.indexOf (text, true));
+
+        auto choices = parameter.getAllValueStrings();
+
+        if (choices.isEmpty() || paramID == "mode")
+            return text;
+
+        if (choices.contains (text, true))
+            return choices[choices.indexOf (text, true)];
+
+        if (text.isNotEmpty() && text.containsOnly ("0123456789") && text.getIntValue() < choices.size())
+            return choices[text.getIntValue()];
+
+        return {};
+    }
+
+    juce::Array<juce::File> findInputs (const juce::ArgumentList& args)
+    {
+        juce::Array<juce::File> inputs;
+
+        for (auto& argument : args.arguments)
+        {
+            if (argument.isOption())
+                continue;
+
+            auto file = argument.resolveAsFile();
+
+            if (file.isDirectory())
+            {
+                for (auto& entry : juce::RangedDirectoryIterator (file, false, "*", juce::File::findFiles))
+                    if (audioExtensions.contains (entry.getFile().getFileExtension(), true))
+                        inputs.add (entry.getFile());
+            }
+            else
+            {
+                inputs.add (file);
+            }
+        }
+
+        return inputs;
+    }
+
+    /** Runs the --pipe mode, reporting on stderr since stdout is the audio. */
+    int runPipeMode (const juce::ArgumentList& args, const RenderSettings& settings)
+    {
+        PcmFormat input, output;
+
+        if (! PcmFormat::parse (args.containsOption ("--input-format") ? args.getValueForOption ("--input-format") : "wav", input))
+        {
+            std::cerr << "--input-format must be wav, f32, s16, s24 or s32" << std::endl;
+            return 1;
+        }
+
+        if (! PcmFormat::parse (args.containsOption ("--output-format") ? args.getValueForOption ("--output-format")
+                                                                        : juce::String (input.wav ? "wav" : "f32"), output))
+        {
+            std::cerr << "--output-format must be wav, f32, s16, s24 or s32, or wav: and one of those four" << std::endl;
+            return 1;
+        }
+
+        if (args.containsOption ("--channels"))
+            input.numChannels = args.getValueForOption ("--channels").getIntValue();
+
+        if (args.containsOption ("--rate"))
+            input.sampleRate = args.getValueForOption ("--rate").getDoubleValue();
+
+        if (! input.wav && (input.numChannels <= 0 || input.sampleRate <= 0.0))
+        {
+            std::cerr << "--channels and --rate must be positive" << std::endl;
+            return 1;
+        }
+
+        auto result = runPipe (input, output, settings);
+
+        if (result.failed())
+            std::cerr << result.getErrorMessage() << std::endl;
+
+        return result.wasOk() ? 0 : 1;
+    }
+
+    //==============================================================================
+    /** Renders one file on a pool thread and prints how it went. */
+    class RenderJob : public juce::ThreadPoolJob
+    {
+    public:
+        RenderJob (const juce::File& input, const juce::File& output, const RenderSettings& settings, int numChunkThreads)
+            : juce::ThreadPoolJob (input.getFileName()),
+              _input (input),
+              _output (output),
+              _settings (settings),
+              _numChunkThreads (numChunkThreads)
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            auto start = juce::Time::getMillisecondCounterHiRes();
+            _result = _numChunkThreads > 1 ? renderFileParallel (_input, _output, _settings, _numChunkThreads)
+                                           : renderFile (_input, _output, _settings);
+            auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+            const juce::ScopedLock lock (getOutputLock());
+
+            if (_result.wasOk())
+                std::cout << _input.getFileName() << " -> " << _output.getFullPathName()
+                          << " (" << juce::String (seconds, 2) << " s)" << std::endl;
+            else
+                std::cerr << _input.getFileName() << ": " << _result.getErrorMessage() << std::endl;
+
+            return jobHasFinished;
+        }
+
+        bool failed() const     { return _result.failed(); }
+
+    private:
+        static juce::CriticalSection& getOutputLock()
+        {
+            static juce::CriticalSection lock;
+            return lock;
+        }
+
+        juce::File _input, _output;
+        const RenderSettings& _settings;
+        const int _numChunkThreads;
+        juce::Result _result { juce::Result::fail ("not rendered") };
+    };
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    // only used to look parameters up; every job makes its own
+    PandamoniumAudioProcessor reference;
+
+    if (args.containsOption ("--help|-h") || args.size() == 0)
+    {
+        printUsage (reference);
+        return args.size() == 0 ? 1 : 0;
+    }
+
+    RenderSettings settings;
+    settings.blockSize = args.containsOption ("--block-size") ? args.getValueForOption ("--block-size").getIntValue() : 4096;
+    settings.bitsPerSample = args.getValueForOption ("--bits").getIntValue();
+    settings.memoryMapped = ! args.containsOption ("--no-mmap");
+
+    if (settings.blockSize <= 0)
+    {
+        std::cerr << "--block-size must be at least 1" << std::endl;
+        return 1;
+    }
+
+    auto presetPath = args.getValueForOption ("--preset");
+
+    if (presetPath.isNotEmpty())
+    {
+        settings.preset = loadPreset (args.getFileForOption ("--preset"));
+
+        if (settings.preset.isEmpty())
+        {
+            std::cerr << "couldn't read a preset from " << presetPath << std::endl;
+            return 1;
+        }
+    }
+
+    for (auto* parameter : reference.getParameters())
+    {
+        auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (parameter);
+
+        if (withID == nullptr || ! args.containsOption ("--" + withID->paramID))
+            continue;
+
+        auto text = args.getValueForOption ("--" + withID->paramID);
+        auto value = parseParameterValue (*parameter, withID->paramID, text);
+
+        if (value.isEmpty())
+        {
+            std::cerr << "--" << withID->paramID << " must be one of: "
+                      << parameter->getAllValueStrings().joinIntoString (", ") << std::endl;
+            return 1;
+        }
+
+        settings.parameters.set (withID->paramID, value);
+    }
+
+    if (args.containsOption ("--save-preset"))
+    {
+        auto state = OfflineFuzz (settings).getState();
+
+        if (state == nullptr || ! state->writeTo (args.getFileForOption ("--save-preset")))
+        {
+            std::cerr << "couldn't save the preset" << std::endl;
+            return 1;
+        }
+    }
+
+    if (args.containsOption ("--pipe"))
+        return runPipeMode (args, settings);
+
+    auto inputs = findInputs (args);
+
+    if (inputs.isEmpty())
+        return args.containsOption ("--save-preset") ? 0 : 1;
+
+    auto outputDir = args.containsOption ("--output-dir") ? args.getFileForOption ("--output-dir") : juce::File();
+
+    if (outputDir != juce::File() && ! outputDir.createDirectory())
+    {
+        std::cerr << "couldn't create " << outputDir.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    auto suffix = args.containsOption ("--suffix") ? args.getValueForOption ("--suffix") : juce::String ("-fuzz");
+    auto format = args.getValueForOption ("--format").trimCharactersAtStart (".");
+
+    auto numThreads = juce::jmax (1, args.containsOption ("--jobs") ? args.getValueForOption ("--jobs").getIntValue()
+                                                                    : juce::SystemStats::getNumCpus());
+
+    // several files keep the threads busy a file each; one is split up
+    auto numJobs = juce::jmin (inputs.size(), numThreads);
+    auto numChunkThreads = inputs.size() == 1 ? numThreads : 1;
+
+    juce::ThreadPool pool (numJobs);
+    juce::OwnedArray<RenderJob> jobs;
+
+    for (auto& input : inputs)
+    {
+        auto folder = outputDir != juce::File() ? outputDir : input.getParentDirectory();
+        auto extension = format.isNotEmpty() ? "." + format : input.getFileExtension();
+        auto output = folder.getChildFile (input.getFileNameWithoutExtension() + suffix + extension);
+
+        if (output == input)
+        {
+            std::cerr << input.getFileName() << ": would overwrite itself, give a --suffix or --output-dir" << std::endl;
+            return 1;
+        }
+
+        pool.addJob (jobs.add (new RenderJob (input, output, settings, numChunkThreads)), false);
+    }
+
+    auto start = juce::Time::getMillisecondCounterHiRes();
+
+    for (auto* job : jobs)
+        pool.waitForJobToFinish (job, -1);
+
+    auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+    auto numFailed = std::count_if (jobs.begin(), jobs.end(), [] (RenderJob* job) { return job->failed(); });
+
+    std::cout << std::endl << jobs.size() - (int) numFailed << " of " << jobs.size() << " files rendered in "
+              << juce::String (seconds, 2) << " s on " << numThreads << " threads" << std::endl;
+
+    return numFailed == 0 ? 0 : 1;
+}
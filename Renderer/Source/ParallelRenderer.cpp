@@ -0,0 +1,312 @@
+/*
+  ==============================================================================
+
+    ParallelRenderer.cpp
+    Renders one long file on several cores at once.
+
+  ==============================================================================
+*/
+
+#include "ParallelRenderer.h"
+
+#include <cstring>
+#include <deque>
+
+namespace
+{
+    // at most about 11 s at 48 kHz, so the chunks in flight stay small
+    constexpr int maxChunkSamples = 1 << 19;
+
+    // enough queued per thread that no core waits on the one being written
+    constexpr int chunksPerThread = 2;
+
+    // a warm-up runs through at least this much audio, and retries
+    // through this many times more
+    constexpr double minWarmUpSeconds = 0.25;
+    constexpr int retryWarmUpFactor = 16;
+
+    // from the start of the file, not from a warm-up
+    constexpr juce::int64 fromStart = -1;
+
+    juce::int64 roundUp (juce::int64 samples, juce::int64 multiple)
+    {
+        return (samples + multiple - 1) / multiple * multiple;
+    }
+
+    //==============================================================================
+    /** The output of the first few blocks with sound in them after a seam.
+        Those are always processed, where silent ones might be skipped and
+        say nothing about the processor's state.
+    */
+    struct SeamCheck
+    {
+        juce::AudioBuffer<float> samples;
+        int numSamples = 0;
+        int length = 0;
+
+        void prepare (int numChannels, int checkLength, int blockSize)
+        {
+            samples.setSize (numChannels, checkLength + blockSize);
+            numSamples = 0;
+            length = checkLength;
+        }
+
+        bool isFull() const     { return numSamples >= length; }
+
+        void add (const juce::AudioBuffer<float>& block)
+        {
+            for (int channel = 0; channel < samples.getNumChannels(); ++channel)
+                samples.copyFrom (channel, numSamples, block, channel, 0, block.getNumSamples());
+
+            numSamples += block.getNumSamples();
+        }
+
+        bool operator== (const SeamCheck& other) const
+        {
+            if (numSamples != other.numSamples)
+                return false;
+
+            for (int channel = 0; channel < samples.getNumChannels(); ++channel)
+                if (std::memcmp (samples.getReadPointer (channel), other.samples.getReadPointer (channel),
+                                 sizeof (float) * (size_t) numSamples) != 0)
+                    return false;
+
+            return true;
+        }
+    };
+
+    //==============================================================================
+    /** One chunk of the processed stream, rendered into memory, along with
+        the checks for the seams at either end of it.
+    */
+    class ChunkJob : public juce::ThreadPoolJob
+    {
+    public:
+        ChunkJob (const juce::File& input, const RenderSettings& settings, juce::int64 totalLength,
+                  juce::int64 start, juce::int64 end, juce::int64 warmUp, int checkLength)
+            : juce::ThreadPoolJob ("chunk at " + juce::String (start)),
+              _input (input),
+              _settings (settings),
+              _totalLength (totalLength),
+              _start (start),
+              _end (end),
+              _warmUp (warmUp),
+              _checkLength (checkLength)
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            _result = render();
+            return jobHasFinished;
+        }
+
+        const juce::Result& getResult() const           { return _result; }
+        juce::int64 getStart() const                    { return _start; }
+        juce::int64 getEnd() const                      { return _end; }
+
+        /** Samples from the start of the chunk to its end. */
+        const juce::AudioBuffer<float>& getOutput() const    { return _output; }
+
+        const SeamCheck& getStartCheck() const          { return _startCheck; }
+        const SeamCheck& getEndCheck() const            { return _endCheck; }
+
+    private:
+        juce::Result render()
+        {
+            juce::AudioFormatManager formats;
+            formats.registerBasicFormats();
+
+            auto reader = openReader (formats, _input, _settings);
+
+            if (reader == nullptr)
+                return juce::Result::fail ("couldn't open " + _input.getFullPathName() + " as audio");
+
+            auto numChannels = (int) reader->numChannels;
+            OfflineFuzz fuzz (_settings);
+            auto prepared = fuzz.prepare (reader->sampleRate, numChannels);
+
+            if (prepared.failed())
+                return prepared;
+
+            const auto blockSize = juce::jmax (1, _settings.blockSize);
+            const auto threshold = fuzz.getSilenceThreshold();
+            juce::AudioBuffer<float> buffer (numChannels, blockSize);
+
+            auto position = _warmUp == fromStart ? 0 : findWarmUpStart (*reader, buffer, threshold);
+            _output.setSize (numChannels, (int) (_end - _start));
+            _startCheck.prepare (numChannels, _checkLength, blockSize);
+            _endCheck.prepare (numChannels, _checkLength, blockSize);
+
+            // the same blocks a serial render would process, from position on,
+            // and past the end until there's enough to check the seam there
+            for (; position < _totalLength && (position < _end || ! _endCheck.isFull()); position += blockSize)
+            {
+                if (shouldExit())
+                    return juce::Result::fail ("cancelled");
+
+                auto numSamples = (int) juce::jmin ((juce::int64) blockSize, _totalLength - position);
+                buffer.setSize (numChannels, numSamples, false, false, true);
+
+                if (! readBlock (*reader, buffer, position, numSamples))
+                    return juce::Result::fail ("couldn't read from " + _input.getFullPathName());
+
+                auto hasSound = ! isSilent (buffer, threshold);
+                fuzz.process (buffer);
+
+                if (hasSound && position >= _start && ! _startCheck.isFull())
+                    _startCheck.add (buffer);
+
+                if (hasSound && position >= _end && ! _endCheck.isFull())
+                    _endCheck.add (buffer);
+
+                auto first = juce::jmax (position, _start);
+                auto last = juce::jmin (position + numSamples, _end);
+
+                for (int channel = 0; channel < numChannels && first < last; ++channel)
+                    _output.copyFrom (channel, (int) (first - _start), buffer, channel, (int) (first - position), (int) (last - first));
+            }
+
+            return juce::Result::ok();
+        }
+
+        static bool isSilent (const juce::AudioBuffer<float>& buffer, float threshold)
+        {
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                if (buffer.getMagnitude (channel, 0, buffer.getNumSamples()) > threshold)
+                    return false;
+
+            return true;
+        }
+
+        /** Walks back from the start a block at a time until it has passed
+            _warmUp samples of blocks with sound in them, which a serial
+            render must have processed too, or reached the start.
+        */
+        juce::int64 findWarmUpStart (juce::AudioFormatReader& reader, juce::AudioBuffer<float>& buffer, float threshold)
+        {
+            const auto blockSize = buffer.getNumSamples();
+            auto position = _start;
+            juce::int64 processed = 0;
+
+            while (position > 0 && processed < _warmUp)
+            {
+                position -= blockSize;
+
+                // a block that can't be read doesn't count, which at worst
+                // makes the warm-up longer
+                if (readBlock (reader, buffer, position, blockSize) && ! isSilent (buffer, threshold))
+                    processed += blockSize;
+            }
+
+            return position;
+        }
+
+        const juce::File _input;
+        const RenderSettings& _settings;
+        const juce::int64 _totalLength, _start, _end, _warmUp;
+        const int _checkLength;
+
+        juce::AudioBuffer<float> _output;
+        SeamCheck _startCheck, _endCheck;
+        juce::Result _result { juce::Result::fail ("not rendered") };
+    };
+}
+
+//==============================================================================
+juce::Result renderChunks (const juce::File& input, juce::AudioFormatReader& reader, juce::AudioFormatWriter& writer,
+                           const RenderSettings& settings, int numThreads)
+{
+    auto numChannels = (int) reader.numChannels;
+    OfflineFuzz probe (settings);
+    auto prepared = probe.prepare (reader.sampleRate, numChannels);
+
+    if (prepared.failed())
+        return prepared;
+
+    const juce::int64 blockSize = juce::jmax (1, settings.blockSize);
+    const juce::int64 latency = probe.getLatencySamples();
+    const juce::int64 tail = probe.getTailLengthSamples();
+    const auto totalLength = reader.lengthInSamples + latency;
+
+    const auto warmUp = roundUp (juce::jmax ((juce::int64) (minWarmUpSeconds * reader.sampleRate), 16 * tail), blockSize);
+    const auto checkLength = (int) roundUp (juce::jmax ((juce::int64) 4096, 4 * tail), blockSize);
+    const auto chunkLength = roundUp (juce::jlimit (4 * warmUp, juce::jmax (4 * warmUp, (juce::int64) maxChunkSamples),
+                                                    totalLength / juce::jmax (1, numThreads)),
+                                      blockSize);
+
+    if (numThreads <= 1 || totalLength <= chunkLength)
+        return renderStream (reader, writer, settings);
+
+    const auto numChunks = (int) ((totalLength + chunkLength - 1) / chunkLength);
+
+    auto makeChunk = [&] (int index, juce::int64 chunkWarmUp)
+    {
+        auto start = index * chunkLength;
+        auto end = juce::jmin (start + chunkLength, totalLength);
+
+        return std::make_unique<ChunkJob> (input, settings, totalLength, start, end, index == 0 ? fromStart : chunkWarmUp, checkLength);
+    };
+
+    // declared first so the pool, and any job still running, goes before them
+    std::deque<std::unique_ptr<ChunkJob>> inFlight;
+    juce::ThreadPool pool (numThreads);
+    int nextChunk = 0;
+
+    auto queueChunks = [&]
+    {
+        while (nextChunk < numChunks && (int) inFlight.size() < numThreads * chunksPerThread)
+        {
+            inFlight.push_back (makeChunk (nextChunk++, warmUp));
+            pool.addJob (inFlight.back().get(), false);
+        }
+    };
+
+    SeamCheck previousEnd;
+
+    for (int index = 0; index < numChunks; ++index)
+    {
+        queueChunks();
+
+        auto chunk = std::move (inFlight.front());
+        inFlight.pop_front();
+        pool.waitForJobToFinish (chunk.get(), -1);
+
+        // a seam that doesn't match means the warm-up wasn't long enough to
+        // settle; try a much longer one, then render from the very start
+        if (chunk->getResult().wasOk() && index > 0 && ! (chunk->getStartCheck() == previousEnd))
+        {
+            for (auto retryWarmUp : { warmUp * retryWarmUpFactor, fromStart })
+            {
+                chunk = makeChunk (index, retryWarmUp);
+                chunk->runJob();
+
+                if (chunk->getResult().failed() || retryWarmUp == fromStart || chunk->getStartCheck() == previousEnd)
+                    break;
+            }
+        }
+
+        if (chunk->getResult().failed())
+            return chunk->getResult();
+
+        // the processed stream runs latency samples ahead of the file
+        auto& output = chunk->getOutput();
+        auto first = juce::jmax (chunk->getStart(), latency);
+
+        if (first < chunk->getEnd()
+             && ! writer.writeFromAudioSampleBuffer (output, (int) (first - chunk->getStart()), (int) (chunk->getEnd() - first)))
+            return juce::Result::fail ("couldn't write to the output");
+
+        previousEnd = chunk->getEndCheck();
+    }
+
+    return juce::Result::ok();
+}
+
+juce::Result renderFileParallel (const juce::File& input, const juce::File& output, const RenderSettings& settings, int numThreads)
+{
+    return renderFile (input, output, settings, [&] (juce::AudioFormatReader& reader, juce::AudioFormatWriter& writer)
+    {
+        return renderChunks (input, reader, writer, settings, numThreads);
+    });
+}
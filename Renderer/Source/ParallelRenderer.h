@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    ParallelRenderer.h
+    Renders one long file on several cores at once.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FileRenderer.h"
+
+/** Like renderStream, but splits the file into chunks rendered at once on
+    numThreads threads, and comes out sample for sample the same.
+
+    The processor isn't stateless: the oversampling filters remember what
+    came before, ADAA remembers the last sample and silent blocks are only
+    skipped once the tail has played out. So each chunk gets its own
+    processor, started early on a warm-up that's thrown away, and its
+    blocks fall exactly where a serial render's would.
+
+    The warm-up begins on a block that isn't silent, so the silence count
+    agrees with a serial render's from there, and runs through enough
+    processed samples for any difference left in the filters to die away.
+    To check, every chunk renders on past its end through the first few
+    blocks with sound in them, which can't have been skipped, and the next
+    chunk has to start with the same output bit for bit. One that doesn't
+    is rendered again with a much longer warm-up, and failing that from the
+    very start of the file, which can't differ.
+
+    Chunks are rendered into memory and written in order, with only a few
+    per thread in flight at once, so memory stays bounded however long the
+    file is. The reader is only used for its format; each chunk opens input
+    for itself.
+*/
+juce::Result renderChunks (const juce::File& input, juce::AudioFormatReader& reader, juce::AudioFormatWriter& writer,
+                           const RenderSettings& settings, int numThreads);
+
+/** renderFile with renderChunks. */
+juce::Result renderFileParallel (const juce::File& input, const juce::File& output, const RenderSettings& settings, int numThreads);
@@ -0,0 +1,521 @@
+/*
+  ==============================================================================
+
+    PcmPipe.cpp
+    Filters PCM from stdin to stdout, for shell pipelines.
+
+  ==============================================================================
+*/
+
+#include "PcmPipe.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#if JUCE_WINDOWS
+ #include <fcntl.h>
+ #include <io.h>
+#endif
+
+namespace
+{
+    // one each being read, processed and written
+    constexpr int numChunks = 3;
+
+    constexpr juce::uint16 wavePcm = 1;
+    constexpr juce::uint16 waveFloat = 3;
+    constexpr juce::uint16 waveExtensible = 0xfffe;
+
+    // what follows the format tag in a WAVE_FORMAT_EXTENSIBLE sub-format GUID
+    constexpr juce::uint8 extensibleGuidTail[] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00,
+                                                   0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 };
+
+    // nothing before the data is anywhere near this big, so a chunk that
+    // says it is must be garbage
+    constexpr juce::uint64 maxHeaderChunkSize = 1 << 24;
+
+    int getBytesPerSample (PcmEncoding encoding)
+    {
+        switch (encoding)
+        {
+            case PcmEncoding::int16:    return 2;
+            case PcmEncoding::int24:    return 3;
+            case PcmEncoding::int32:    return 4;
+            case PcmEncoding::float32:  return 4;
+        }
+
+        return 4;
+    }
+
+    //==============================================================================
+    bool readExactly (void* dest, size_t numBytes)
+    {
+        return std::fread (dest, 1, numBytes, stdin) == numBytes;
+    }
+
+    juce::uint32 readLittleEndian (const char* bytes, int numBytes)
+    {
+        juce::uint32 value = 0;
+
+        for (int i = numBytes; --i >= 0;)
+            value = (value << 8) | (juce::uint8) bytes[i];
+
+        return value;
+    }
+
+    /** Reads a WAV header from stdin up to the start of the sample data.
+        Tools writing to a pipe can't know the data chunk's size in advance
+        and leave it 0 or all ones, in which case everything after it is
+        read as samples; otherwise reading stops where it says.
+    */
+    juce::Result readWavHeader (PcmFormat& format)
+    {
+        char riff[12];
+
+        if (! readExactly (riff, sizeof (riff)) || memcmp (riff, "RIFF", 4) != 0 || memcmp (riff + 8, "WAVE", 4) != 0)
+            return juce::Result::fail ("stdin isn't a WAV stream");
+
+        auto haveFormat = false;
+
+        for (;;)
+        {
+            char header[8];
+
+            if (! readExactly (header, sizeof (header)))
+                return juce::Result::fail ("the WAV stream ended before its data");
+
+            auto size = readLittleEndian (header + 4, 4);
+
+            if (memcmp (header, "data", 4) == 0)
+            {
+                format.dataSize = size != 0xffffffff ? size : 0;
+                return haveFormat ? juce::Result::ok() : juce::Result::fail ("the WAV stream has no format chunk");
+            }
+
+            // chunks are padded to an even size, which for 0xffffffff needs
+            // more than 32 bits
+            auto paddedSize = ((juce::uint64) size + 1) & ~(juce::uint64) 1;
+
+            if (paddedSize > maxHeaderChunkSize)
+                return juce::Result::fail ("the WAV stream has a " + juce::String ((juce::uint64) size)
+                                           + " byte chunk before its data, which can't be right");
+
+            juce::HeapBlock<char> chunk ((size_t) paddedSize);
+
+            if (! readExactly (chunk, (size_t) paddedSize))
+                return juce::Result::fail ("the WAV stream ended before its data");
+
+            if (memcmp (header, "fmt ", 4) != 0)
+                continue;
+
+            if (size < 16)
+                return juce::Result::fail ("the WAV stream's format chunk is too short");
+
+            auto tag = (juce::uint16) readLittleEndian (chunk + 0, 2);
+            auto bits = (int) readLittleEndian (chunk + 14, 2);
+
+            if (tag == waveExtensible && size >= 26)
+                tag = (juce::uint16) readLittleEndian (chunk + 24, 2);
+
+            format.numChannels = (int) readLittleEndian (chunk + 2, 2);
+            format.sampleRate = (double) readLittleEndian (chunk + 4, 4);
+
+            if (tag == waveFloat && bits == 32)         format.encoding = PcmEncoding::float32;
+            else if (tag == wavePcm && bits == 16)      format.encoding = PcmEncoding::int16;
+            else if (tag == wavePcm && bits == 24)      format.encoding = PcmEncoding::int24;
+            else if (tag == wavePcm && bits == 32)      format.encoding = PcmEncoding::int32;
+            else
+                return juce::Result::fail ("the WAV stream is " + juce::String (bits) + " bit, format " + juce::String (tag)
+                                           + ", which isn't supported");
+
+            haveFormat = true;
+        }
+    }
+
+    /** The speakers WAVE_FORMAT_EXTENSIBLE assumes for each channel count,
+        as ffmpeg lays them out, or none past 7.1.
+    */
+    juce::uint32 getDefaultChannelMask (int numChannels)
+    {
+        switch (numChannels)
+        {
+            case 1:     return 0x4;         // centre
+            case 2:     return 0x3;         // left, right
+            case 3:     return 0x7;         // + centre
+            case 4:     return 0x107;       // + back centre
+            case 5:     return 0x37;        // L R C, back left and right
+            case 6:     return 0x3f;        // 5.1
+            case 7:     return 0x13f;       // 6.1
+            case 8:     return 0x63f;       // 7.1
+            default:    return 0;
+        }
+    }
+
+    /** A WAV header for a stream of unknown length, with the sizes all ones
+        as other tools write when piping. Past stereo, or integers deeper
+        than 16 bits, it's WAVE_FORMAT_EXTENSIBLE, which is what readers
+        expect for those.
+    */
+    juce::MemoryBlock makeWavHeader (const PcmFormat& format)
+    {
+        juce::MemoryOutputStream header;
+        auto bytesPerFrame = format.getBytesPerFrame();
+        auto bits = 8 * getBytesPerSample (format.encoding);
+        auto tag = format.encoding == PcmEncoding::float32 ? waveFloat : wavePcm;
+        auto extensible = format.numChannels > 2 || (tag == wavePcm && bits > 16);
+
+        header.write ("RIFF", 4);
+        header.writeInt ((int) 0xffffffff);
+        header.write ("WAVEfmt ", 8);
+        header.writeInt (extensible ? 40 : 16);
+        header.writeShort ((short) (extensible ? waveExtensible : tag));
+        header.writeShort ((short) format.numChannels);
+        header.writeInt ((int) format.sampleRate);
+        header.writeInt ((int) format.sampleRate * bytesPerFrame);
+        header.writeShort ((short) bytesPerFrame);
+        header.writeShort ((short) bits);
+
+        if (extensible)
+        {
+            header.writeShort (22);                 // size of what follows
+            header.writeShort ((short) bits);       // valid bits
+            header.writeInt ((int) getDefaultChannelMask (format.numChannels));
+            header.writeShort ((short) tag);
+            header.write (extensibleGuidTail, sizeof (extensibleGuidTail));
+        }
+
+        header.write ("data", 4);
+        header.writeInt ((int) 0xffffffff);
+
+        return header.getMemoryBlock();
+    }
+
+    //==============================================================================
+    void convertFromPcm (PcmEncoding encoding, const char* source, juce::AudioBuffer<float>& dest, int numFrames)
+    {
+        auto numChannels = dest.getNumChannels();
+        auto stride = numChannels * getBytesPerSample (encoding);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* from = source + channel * getBytesPerSample (encoding);
+            auto* to = dest.getWritePointer (channel);
+
+            switch (encoding)
+            {
+                case PcmEncoding::int16:    juce::AudioDataConverters::convertInt16LEToFloat (from, to, numFrames, stride); break;
+                case PcmEncoding::int24:    juce::AudioDataConverters::convertInt24LEToFloat (from, to, numFrames, stride); break;
+                case PcmEncoding::int32:    juce::AudioDataConverters::convertInt32LEToFloat (from, to, numFrames, stride); break;
+                case PcmEncoding::float32:  juce::AudioDataConverters::convertFloat32LEToFloat (from, to, numFrames, stride); break;
+            }
+        }
+    }
+
+    void convertToPcm (PcmEncoding encoding, const juce::AudioBuffer<float>& source, int start, int numFrames, char* dest)
+    {
+        auto numChannels = source.getNumChannels();
+        auto stride = numChannels * getBytesPerSample (encoding);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* from = source.getReadPointer (channel, start);
+            auto* to = dest + channel * getBytesPerSample (encoding);
+
+            switch (encoding)
+            {
+                case PcmEncoding::int16:    juce::AudioDataConverters::convertFloatToInt16LE (from, to, numFrames, stride); break;
+                case PcmEncoding::int24:    juce::AudioDataConverters::convertFloatToInt24LE (from, to, numFrames, stride); break;
+                case PcmEncoding::int32:    juce::AudioDataConverters::convertFloatToInt32LE (from, to, numFrames, stride); break;
+                case PcmEncoding::float32:  juce::AudioDataConverters::convertFloatToFloat32LE (from, to, numFrames, stride); break;
+            }
+        }
+    }
+
+    //==============================================================================
+    /** A block of audio on its way through, with room for it as PCM. */
+    struct Chunk
+    {
+        juce::AudioBuffer<float> audio;
+        juce::HeapBlock<char> bytes;
+        int numFrames = 0;
+        int skip = 0;           // frames at the start still inside the latency
+        bool last = false;
+    };
+
+    /** Hands chunks from one thread to the next. Closing it wakes everyone
+        waiting with nothing, which is how a failure stops the others.
+    */
+    class ChunkQueue
+    {
+    public:
+        void push (Chunk* chunk)
+        {
+            {
+                const std::lock_guard<std::mutex> lock (_mutex);
+                _chunks.push_back (chunk);
+            }
+
+            _ready.notify_one();
+        }
+
+        /** Waits for a chunk. Returns nullptr once closed. */
+        Chunk* pop()
+        {
+            std::unique_lock<std::mutex> lock (_mutex);
+            _ready.wait (lock, [this] { return _closed || ! _chunks.empty(); });
+
+            if (_closed)
+                return nullptr;
+
+            auto* chunk = _chunks.front();
+            _chunks.pop_front();
+            return chunk;
+        }
+
+        void close()
+        {
+            {
+                const std::lock_guard<std::mutex> lock (_mutex);
+                _closed = true;
+            }
+
+            _ready.notify_all();
+        }
+
+    private:
+        std::mutex _mutex;
+        std::condition_variable _ready;
+        std::deque<Chunk*> _chunks;
+        bool _closed = false;
+    };
+
+    //==============================================================================
+    class Pipe
+    {
+    public:
+        Pipe (const PcmFormat& input, const PcmFormat& output, int blockSize)
+            : _input (input), _output (output), _blockSize (blockSize)
+        {
+            auto numBytes = (size_t) blockSize * (size_t) juce::jmax (input.getBytesPerFrame(), output.getBytesPerFrame());
+
+            for (auto& chunk : _chunks)
+            {
+                chunk.audio.setSize (input.numChannels, blockSize);
+                chunk.bytes.malloc (numBytes);
+                _free.push (&chunk);
+            }
+        }
+
+        juce::Result run (OfflineFuzz& fuzz)
+        {
+            std::thread reader ([this] { readLoop(); });
+            std::thread writer ([this] { writeLoop(); });
+
+            processLoop (fuzz);
+
+            reader.join();
+            writer.join();
+
+            const std::lock_guard<std::mutex> lock (_errorLock);
+            return _error.isEmpty() ? juce::Result::ok() : juce::Result::fail (_error);
+        }
+
+    private:
+        void fail (const juce::String& error)
+        {
+            {
+                const std::lock_guard<std::mutex> lock (_errorLock);
+
+                if (_error.isEmpty())
+                    _error = error;
+            }
+
+            _free.close();
+            _filled.close();
+            _processed.close();
+        }
+
+        void readLoop()
+        {
+            auto bytesPerFrame = (size_t) _input.getBytesPerFrame();
+            auto blockBytes = bytesPerFrame * (size_t) _blockSize;
+
+            // anything after a WAV's data chunk isn't samples
+            auto limited = _input.wav && _input.dataSize > 0;
+            auto remaining = _input.dataSize;
+
+            while (auto* chunk = _free.pop())
+            {
+                auto wanted = limited ? (size_t) juce::jmin ((juce::uint64) blockBytes, remaining) : blockBytes;
+                auto got = std::fread (chunk->bytes, 1, wanted, stdin);
+
+                if (std::ferror (stdin))
+                    return fail ("couldn't read from stdin");
+
+                remaining -= limited ? got : 0;
+
+                // a partial frame at the very end is dropped
+                chunk->numFrames = (int) (got / bytesPerFrame);
+                chunk->last = got < blockBytes;
+                chunk->audio.setSize (_input.numChannels, chunk->numFrames, false, false, true);
+                convertFromPcm (_input.encoding, chunk->bytes, chunk->audio, chunk->numFrames);
+
+                auto last = chunk->last;
+                _filled.push (chunk);
+
+                if (last)
+                    return;
+            }
+        }
+
+        void processLoop (OfflineFuzz& fuzz)
+        {
+            auto toSkip = fuzz.getLatencySamples();
+            auto toFlush = toSkip;
+
+            auto process = [&] (Chunk& chunk)
+            {
+                if (chunk.numFrames > 0)
+                    fuzz.process (chunk.audio);
+
+                chunk.skip = juce::jmin (toSkip, chunk.numFrames);
+                toSkip -= chunk.skip;
+            };
+
+            for (;;)
+            {
+                auto* chunk = _filled.pop();
+
+                if (chunk == nullptr)
+                    return;
+
+                auto last = chunk->last;
+                chunk->last = false;
+                process (*chunk);
+                _processed.push (chunk);
+
+                if (last)
+                    break;
+            }
+
+            // run on through silence for the latency, so the end of the
+            // input makes it out, then tell the writer that's everything
+            while (toFlush >= 0)
+            {
+                auto* chunk = _free.pop();
+
+                if (chunk == nullptr)
+                    return;
+
+                chunk->numFrames = juce::jmin (toFlush, _blockSize);
+                chunk->audio.setSize (_input.numChannels, chunk->numFrames, false, false, true);
+                chunk->audio.clear();
+                process (*chunk);
+
+                toFlush -= juce::jmax (1, chunk->numFrames);
+                chunk->last = toFlush < 0;
+                _processed.push (chunk);
+            }
+        }
+
+        void writeLoop()
+        {
+            if (_output.wav)
+            {
+                auto header = makeWavHeader (_output);
+
+                if (std::fwrite (header.getData(), 1, header.getSize(), stdout) != header.getSize())
+                    return fail ("couldn't write to stdout");
+            }
+
+            auto bytesPerFrame = (size_t) _output.getBytesPerFrame();
+
+            while (auto* chunk = _processed.pop())
+            {
+                auto numFrames = chunk->numFrames - chunk->skip;
+
+                if (numFrames > 0)
+                {
+                    convertToPcm (_output.encoding, chunk->audio, chunk->skip, numFrames, chunk->bytes);
+
+                    if (std::fwrite (chunk->bytes, bytesPerFrame, (size_t) numFrames, stdout) != (size_t) numFrames)
+                        return fail ("couldn't write to stdout");
+                }
+
+                auto last = chunk->last;
+                _free.push (chunk);
+
+                if (last)
+                {
+                    if (std::fflush (stdout) != 0)
+                        fail ("couldn't write to stdout");
+
+                    return;
+                }
+            }
+        }
+
+        const PcmFormat _input, _output;
+        const int _blockSize;
+
+        Chunk _chunks[numChunks];
+        ChunkQueue _free, _filled, _processed;
+
+        std::mutex _errorLock;
+        juce::String _error;
+    };
+}
+
+//==============================================================================
+int PcmFormat::getBytesPerFrame() const
+{
+    return numChannels * getBytesPerSample (encoding);
+}
+
+bool PcmFormat::parse (const juce::String& name, PcmFormat& format)
+{
+    format.wav = name.upToFirstOccurrenceOf (":", false, false).equalsIgnoreCase ("wav");
+
+    auto encoding = format.wav ? name.fromFirstOccurrenceOf (":", false, false) : name;
+
+    if (format.wav && ! name.containsChar (':'))    format.encoding = PcmEncoding::float32;
+    else if (encoding.equalsIgnoreCase ("f32"))     format.encoding = PcmEncoding::float32;
+    else if (encoding.equalsIgnoreCase ("s16"))     format.encoding = PcmEncoding::int16;
+    else if (encoding.equalsIgnoreCase ("s24"))     format.encoding = PcmEncoding::int24;
+    else if (encoding.equalsIgnoreCase ("s32"))     format.encoding = PcmEncoding::int32;
+    else                                            return false;
+
+    return true;
+}
+
+juce::Result runPipe (PcmFormat input, PcmFormat output, const RenderSettings& settings)
+{
+   #if JUCE_WINDOWS
+    _setmode (_fileno (stdin), _O_BINARY);
+    _setmode (_fileno (stdout), _O_BINARY);
+   #endif
+
+    if (input.wav)
+    {
+        auto header = readWavHeader (input);
+
+        if (header.failed())
+            return header;
+    }
+
+    output.numChannels = input.numChannels;
+    output.sampleRate = input.sampleRate;
+
+    OfflineFuzz fuzz (settings);
+    auto prepared = fuzz.prepare (input.sampleRate, input.numChannels);
+
+    if (prepared.failed())
+        return prepared;
+
+    Pipe pipe (input, output, juce::jmax (1, settings.blockSize));
+    return pipe.run (fuzz);
+}
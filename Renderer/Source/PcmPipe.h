@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    PcmPipe.h
+    Filters PCM from stdin to stdout, for shell pipelines.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FileRenderer.h"
+
+//==============================================================================
+/** How samples are laid out in a raw stream or a WAV file's data. */
+enum class PcmEncoding
+{
+    int16,
+    int24,
+    int32,
+    float32
+};
+
+/** What comes in on stdin or goes out on stdout. Raw streams are
+    interleaved little-endian frames with nothing around them; for WAV the
+    rest is read from, or written to, the header.
+*/
+struct PcmFormat
+{
+    bool wav = true;
+    PcmEncoding encoding = PcmEncoding::float32;
+    int numChannels = 2;
+    double sampleRate = 48000.0;
+
+    /** For WAV input, the bytes of samples the header says follow it, or 0
+        when it doesn't say and the stream runs to the end.
+    */
+    juce::uint64 dataSize = 0;
+
+    int getBytesPerFrame() const;
+
+    /** Parses f32, s16, s24, s32 or wav, which is float32 unless it's given
+        as one of the others after a colon, e.g. wav:s24. For WAV input the
+        header decides the encoding whatever this says.
+    */
+    static bool parse (const juce::String& name, PcmFormat& format);
+};
+
+/** Reads input from stdin until it ends, runs it through an OfflineFuzz a
+    block at a time and writes it to stdout as output, latency compensated
+    like renderStream.
+
+    Reading, processing and writing each have a thread, handing a few
+    fixed blocks round between them, so the three overlap and memory and
+    latency don't grow with the stream. If input is WAV its header decides
+    the channels, rate and encoding; output's channels and rate always
+    follow the input.
+*/
+juce::Result runPipe (PcmFormat input, PcmFormat output, const RenderSettings& settings);
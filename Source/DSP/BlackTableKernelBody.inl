@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    BlackTableKernelBody.inl
+    Black mode read from a WaveshaperTable, in float only.
+
+    FuzzKernelSet.inl includes this alongside FuzzKernelBody.inl in each
+    instruction set's float namespace. The tables hold floats, and the
+    double kernels are there for accuracy rather than speed, so there's no
+    double version. Don't include it anywhere else.
+
+  ==============================================================================
+*/
+
+//==============================================================================
+/** Black mode read from a WaveshaperTable instead of computing exp(). */
+template <Interpolation Interp>
+struct BlackTableShaper
+{
+    BlackTableShaper (float fuzz, const WaveshaperTable& table) noexcept
+        : _positionPerInput (Vec::broadcast (fuzz * table.getScale())),
+          _maxPosition (Vec::broadcast (table.getMaxPosition())),
+          _points (table.getPoints())
+    {
+    }
+
+    V operator() (V x) const noexcept
+    {
+        // a compare rather than Vec::min, which on some targets passes a
+        // NaN through to gather with; this way it reads the last point
+        auto position = Vec::mul (Vec::abs (x), _positionPerInput);
+        position = Vec::select (Vec::lessThan (position, _maxPosition), position, _maxPosition);
+        auto i = Vec::truncate (position);
+        auto f = Vec::sub (position, Vec::toFloat (i));
+
+        auto p0 = Vec::gather (_points, i);
+        auto p1 = Vec::gather (_points + 1, i);
+        V y;
+
+        if (Interp == Interpolation::Linear)
+        {
+            y = Vec::add (p0, Vec::mul (f, Vec::sub (p1, p0)));
+        }
+        else
+        {
+            auto pm1 = Vec::gather (_points - 1, i);
+            auto p2 = Vec::gather (_points + 2, i);
+
+            // Catmull-Rom, as in WaveshaperTable::lookup()
+            auto c3 = Vec::sub (Vec::add (Vec::mul (Vec::broadcast (3.0f), Vec::sub (p0, p1)), p2), pm1);
+            auto c2 = Vec::sub (Vec::add (Vec::sub (Vec::mul (Vec::broadcast (2.0f), pm1), Vec::mul (Vec::broadcast (5.0f), p0)),
+                                          Vec::mul (Vec::broadcast (4.0f), p1)), p2);
+            auto c1 = Vec::sub (p1, pm1);
+            auto c = Vec::add (c1, Vec::mul (f, Vec::add (c2, Vec::mul (f, c3))));
+            y = Vec::add (p0, Vec::mul (Vec::mul (Vec::broadcast (0.5f), f), c));
+        }
+
+        return Vec::copySign (y, x);
+    }
+
+    V _positionPerInput, _maxPosition;
+    const float* _points;
+};
+
+//==============================================================================
+/** Black mode through a lookup table. */
+template <Interpolation Interp>
+void processBlackTable (float* data, int numSamples, Ramp gain, Ramp volume, Ramp mix, float fuzz,
+                        const WaveshaperTable& table) noexcept
+{
+    processWith (BlackTableShaper<Interp> (fuzz, table), data, numSamples, gain, volume, mix);
+}
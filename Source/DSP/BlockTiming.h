@@ -0,0 +1,211 @@
+/*
+  ==============================================================================
+
+    BlockTiming.h
+    What each processBlock call costs, against its real-time budget.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace pandamonium
+{
+
+//==============================================================================
+/**
+    Running min, mean and max of the time per block, and a histogram of the
+    load (time taken over the block's duration) for percentiles.
+
+    The audio thread is the only writer, so each field is a relaxed atomic
+    it loads and stores without read-modify-write, which costs the same as
+    a plain variable. The one exchange is taking a reset another thread
+    asked for, and only happens once one has. Any other thread can take a
+    snapshot at any time.
+    The fields aren't updated as one, so a snapshot may be a block out in
+    places, which doesn't matter for statistics.
+*/
+class BlockTimingRecorder
+{
+public:
+    /** The histogram has binsPerOctave bins per doubling of load, the
+        first one holding everything under lowestLoad (0.01 %) and the last
+        everything over about 1000 %.
+    */
+    static constexpr int binsPerOctave = 8;
+    static constexpr int numBins = 136;
+    static constexpr double lowestLoad = 1.0e-4;
+
+    /** The load at the top of a bin. */
+    static double getBinUpperLoad (int bin) noexcept
+    {
+        return lowestLoad * std::exp2 ((double) bin / binsPerOctave);
+    }
+
+    struct Snapshot
+    {
+        std::uint64_t numBlocks = 0;
+        std::uint64_t totalNanos = 0;
+        std::uint64_t totalBudgetNanos = 0;
+        std::uint64_t minNanos = 0;
+        std::uint64_t maxNanos = 0;
+        double maxLoad = 0.0;
+        std::uint64_t histogram[numBins] = {};
+
+        double getMeanNanos() const noexcept    { return numBlocks > 0 ? (double) totalNanos / (double) numBlocks : 0.0; }
+
+        /** Total time over total budget, i.e. the share of a core used. */
+        double getMeanLoad() const noexcept     { return totalBudgetNanos > 0 ? (double) totalNanos / (double) totalBudgetNanos : 0.0; }
+
+        /** The load that fraction (0 - 1) of blocks stayed under, to the
+            resolution of the histogram.
+        */
+        double getLoadPercentile (double fraction) const noexcept
+        {
+            std::uint64_t total = 0;
+
+            for (auto count : histogram)
+                total += count;
+
+            if (total == 0)
+                return 0.0;
+
+            auto target = (std::uint64_t) std::ceil (fraction * (double) total);
+            std::uint64_t seen = 0;
+
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                seen += histogram[bin];
+
+                if (seen >= std::max<std::uint64_t> (1, target))
+                    return std::min (getBinUpperLoad (bin), maxLoad);
+            }
+
+            return maxLoad;
+        }
+    };
+
+    /** Audio thread: adds one block. */
+    void record (std::uint64_t nanos, std::uint64_t budgetNanos) noexcept
+    {
+        if (_resetRequested.load (std::memory_order_relaxed) && _resetRequested.exchange (false, std::memory_order_acquire))
+            clear();
+
+        auto numBlocks = _numBlocks.load (std::memory_order_relaxed);
+        auto load = budgetNanos > 0 ? (double) nanos / (double) budgetNanos : 0.0;
+
+        bump (_totalNanos, nanos);
+        bump (_totalBudgetNanos, budgetNanos);
+
+        if (numBlocks == 0 || nanos < _minNanos.load (std::memory_order_relaxed))
+            _minNanos.store (nanos, std::memory_order_relaxed);
+
+        if (nanos > _maxNanos.load (std::memory_order_relaxed))
+            _maxNanos.store (nanos, std::memory_order_relaxed);
+
+        if (load > _maxLoad.load (std::memory_order_relaxed))
+            _maxLoad.store (load, std::memory_order_relaxed);
+
+        bump (_histogram[getBin (load)], 1);
+        _numBlocks.store (numBlocks + 1, std::memory_order_release);
+    }
+
+    /** Any thread. */
+    Snapshot getSnapshot() const noexcept
+    {
+        Snapshot s;
+        s.numBlocks = _numBlocks.load (std::memory_order_acquire);
+        s.totalNanos = _totalNanos.load (std::memory_order_relaxed);
+        s.totalBudgetNanos = _totalBudgetNanos.load (std::memory_order_relaxed);
+        s.minNanos = _minNanos.load (std::memory_order_relaxed);
+        s.maxNanos = _maxNanos.load (std::memory_order_relaxed);
+        s.maxLoad = _maxLoad.load (std::memory_order_relaxed);
+
+        for (int bin = 0; bin < numBins; ++bin)
+            s.histogram[bin] = _histogram[bin].load (std::memory_order_relaxed);
+
+        return s;
+    }
+
+    /** Any thread: starts again from the next block. */
+    void reset() noexcept
+    {
+        _resetRequested.store (true, std::memory_order_release);
+    }
+
+private:
+    static int getBin (double load) noexcept
+    {
+        if (! (load >= lowestLoad))
+            return 0;
+
+        auto bin = (int) std::ceil (std::log2 (load / lowestLoad) * binsPerOctave);
+        return std::min (bin, numBins - 1);
+    }
+
+    static void bump (std::atomic<std::uint64_t>& field, std::uint64_t amount) noexcept
+    {
+        field.store (field.load (std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void clear() noexcept
+    {
+        _numBlocks.store (0, std::memory_order_relaxed);
+        _totalNanos.store (0, std::memory_order_relaxed);
+        _totalBudgetNanos.store (0, std::memory_order_relaxed);
+        _minNanos.store (0, std::memory_order_relaxed);
+        _maxNanos.store (0, std::memory_order_relaxed);
+        _maxLoad.store (0.0, std::memory_order_relaxed);
+
+        for (auto& bin : _histogram)
+            bin.store (0, std::memory_order_relaxed);
+    }
+
+    std::atomic<std::uint64_t> _numBlocks { 0 };
+    std::atomic<std::uint64_t> _totalNanos { 0 };
+    std::atomic<std::uint64_t> _totalBudgetNanos { 0 };
+    std::atomic<std::uint64_t> _minNanos { 0 };
+    std::atomic<std::uint64_t> _maxNanos { 0 };
+    std::atomic<double> _maxLoad { 0.0 };
+    std::atomic<std::uint64_t> _histogram[numBins] = {};
+    std::atomic<bool> _resetRequested { false };
+};
+
+//==============================================================================
+/** Times its own lifetime with the steady clock and records it as one block
+    of numSamples samples. Two clock reads a block, so it can stay on.
+*/
+class ScopedBlockTimer
+{
+public:
+    ScopedBlockTimer (BlockTimingRecorder& recorder, int numSamples, double sampleRate) noexcept
+        : _recorder (recorder),
+          _budgetNanos (sampleRate > 0.0 ? (std::uint64_t) (1.0e9 * numSamples / sampleRate) : 0),
+          _start (Clock::now())
+    {
+    }
+
+    ~ScopedBlockTimer()
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds> (Clock::now() - _start);
+        _recorder.record ((std::uint64_t) elapsed.count(), _budgetNanos);
+    }
+
+    ScopedBlockTimer (const ScopedBlockTimer&) = delete;
+    ScopedBlockTimer& operator= (const ScopedBlockTimer&) = delete;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    BlockTimingRecorder& _recorder;
+    std::uint64_t _budgetNanos;
+    Clock::time_point _start;
+};
+
+} // namespace pandamonium
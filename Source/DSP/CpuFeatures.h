@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    CpuFeatures.h
+    Finds out, once, which of the kernels' instruction sets this CPU runs.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+#include "Simd/SimdTarget.h"
+
+#if PANDAMONIUM_X86 && defined (_MSC_VER) && ! defined (__clang__)
+ #include <intrin.h>
+#endif
+
+namespace pandamonium
+{
+
+//==============================================================================
+enum class InstructionSet
+{
+    Scalar = 0,
+    SSE2,
+    AVX2,
+    AVX512,
+    NEON
+};
+
+inline const char* getInstructionSetName (InstructionSet isa) noexcept
+{
+    switch (isa)
+    {
+        case InstructionSet::Scalar:    return "scalar";
+        case InstructionSet::SSE2:      return "sse2";
+        case InstructionSet::AVX2:      return "avx2";
+        case InstructionSet::AVX512:    return "avx512";
+        case InstructionSet::NEON:      return "neon";
+    }
+
+    return "scalar";
+}
+
+//==============================================================================
+namespace detail
+{
+   #if PANDAMONIUM_X86 && defined (_MSC_VER) && ! defined (__clang__)
+    inline bool cpuHas (InstructionSet isa) noexcept
+    {
+        int info[4] = {};
+        __cpuid (info, 0);
+        const auto maxLeaf = info[0];
+
+        __cpuid (info, 1);
+        const bool sse2 = (info[3] & (1 << 26)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        const bool fma = (info[2] & (1 << 12)) != 0;
+
+        const auto xcr0 = osxsave ? _xgetbv (0) : 0;
+        const bool osSavesYmm = (xcr0 & 0x06) == 0x06;
+        const bool osSavesZmm = (xcr0 & 0xe6) == 0xe6;
+
+        int leaf7[4] = {};
+
+        if (maxLeaf >= 7)
+            __cpuidex (leaf7, 7, 0);
+
+        const bool avx2 = (leaf7[1] & (1 << 5)) != 0;
+        const bool avx512f = (leaf7[1] & (1 << 16)) != 0;
+
+        switch (isa)
+        {
+            case InstructionSet::SSE2:      return sse2;
+            case InstructionSet::AVX2:      return avx && avx2 && fma && osSavesYmm;
+            case InstructionSet::AVX512:    return avx2 && fma && avx512f && osSavesZmm;
+            default:                        return false;
+        }
+    }
+   #elif PANDAMONIUM_X86
+    // __builtin_cpu_supports also checks that the OS saves the wider registers
+    inline bool cpuHas (InstructionSet isa) noexcept
+    {
+        __builtin_cpu_init();
+
+        switch (isa)
+        {
+            case InstructionSet::SSE2:      return __builtin_cpu_supports ("sse2");
+            case InstructionSet::AVX2:      return __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma");
+            case InstructionSet::AVX512:    return __builtin_cpu_supports ("avx512f") && __builtin_cpu_supports ("fma");
+            default:                        return false;
+        }
+    }
+   #else
+    inline bool cpuHas (InstructionSet isa) noexcept
+    {
+        return PANDAMONIUM_NEON && isa == InstructionSet::NEON;
+    }
+   #endif
+}
+
+/** True if this build has kernels for isa and this CPU can run them. */
+inline bool isInstructionSetSupported (InstructionSet isa) noexcept
+{
+    return isa == InstructionSet::Scalar || detail::cpuHas (isa);
+}
+
+/** The widest supported instruction set. Checked once and then cached. */
+inline InstructionSet getBestInstructionSet() noexcept
+{
+    static const InstructionSet best = []
+    {
+        for (auto isa : { InstructionSet::AVX512, InstructionSet::AVX2, InstructionSet::NEON, InstructionSet::SSE2 })
+            if (isInstructionSetSupported (isa))
+                return isa;
+
+        return InstructionSet::Scalar;
+    }();
+
+    return best;
+}
+
+/** The instruction set the kernels should use.
+
+    This is getBestInstructionSet() unless the PANDAMONIUM_ISA environment
+    variable names another one (scalar, sse2, avx2, avx512 or neon), which
+    lets benchmarks and tests pin a particular kernel. A name this CPU can't
+    run is ignored.
+*/
+inline InstructionSet getPreferredInstructionSet() noexcept
+{
+    static const InstructionSet preferred = []
+    {
+        if (auto* forced = std::getenv ("PANDAMONIUM_ISA"))
+            for (auto isa : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2,
+                              InstructionSet::AVX512, InstructionSet::NEON })
+                if (std::strcmp (forced, getInstructionSetName (isa)) == 0 && isInstructionSetSupported (isa))
+                    return isa;
+
+        return getBestInstructionSet();
+    }();
+
+    return preferred;
+}
+
+} // namespace pandamonium
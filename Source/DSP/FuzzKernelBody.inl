@@ -0,0 +1,520 @@
+/*
+  ==============================================================================
+
+    FuzzKernelBody.inl
+    The block kernels, written once against the Vec interface.
+
+    FuzzKernelSet.inl includes this file twice per instruction set, once
+    with its float Vec in scope and once with its VecDouble, so every
+    kernel exists in both precisions. Don't include it anywhere else.
+
+  ==============================================================================
+*/
+
+using V = Vec::Type;
+using Sample = Vec::Sample;
+
+//==============================================================================
+/** x limited to [low, high], with a NaN going to low. Vec::min and Vec::max
+    pass a NaN through on some targets, whereas an ordered compare is false
+    for it everywhere.
+*/
+inline V clampOrdered (V x, Sample low, Sample high) noexcept
+{
+    x = Vec::select (Vec::greaterThan (x, Vec::broadcast (low)), x, Vec::broadcast (low));
+    return Vec::select (Vec::lessThan (x, Vec::broadcast (high)), x, Vec::broadcast (high));
+}
+
+/** exp(x) via Cephes' range reduction to [-ln2/2, ln2/2], then a degree 6
+    polynomial in float (within 2 ulp of std::exp for x in [-87.3, 88.3]) or
+    a Pade approximant in double (within 2 ulp for x in [-708, 709]). Inputs
+    outside those ranges are clamped, so nothing turns into a denormal or an
+    inf, and a NaN is taken as the bottom of the range, so Vec::pow2 never
+    sees one.
+*/
+inline V fastExp (V x) noexcept
+{
+    if constexpr (std::is_same<Sample, double>::value)
+    {
+        x = clampOrdered (x, -708.0, 709.0);
+
+        auto n = Vec::roundNearest (Vec::mul (x, Vec::broadcast (1.4426950408889634074)));
+        auto r = Vec::sub (Vec::sub (x, Vec::mul (n, Vec::broadcast (6.93145751953125e-1))),
+                           Vec::mul (n, Vec::broadcast (1.42860682030941723212e-6)));
+        auto rr = Vec::mul (r, r);
+
+        auto p = Vec::broadcast (1.26177193074810590878e-4);
+        p = Vec::add (Vec::mul (p, rr), Vec::broadcast (3.02994407707441961300e-2));
+        p = Vec::add (Vec::mul (p, rr), Vec::broadcast (9.99999999999999999910e-1));
+        p = Vec::mul (p, r);
+
+        auto q = Vec::broadcast (3.00198505138664455042e-6);
+        q = Vec::add (Vec::mul (q, rr), Vec::broadcast (2.52448340349684104192e-3));
+        q = Vec::add (Vec::mul (q, rr), Vec::broadcast (2.27265548208155028766e-1));
+        q = Vec::add (Vec::mul (q, rr), Vec::broadcast (2.00000000000000000009e0));
+
+        auto y = Vec::add (Vec::broadcast (1.0), Vec::mul (Vec::broadcast (2.0), Vec::div (p, Vec::sub (q, p))));
+        return Vec::mul (y, Vec::pow2 (n));
+    }
+    else
+    {
+        x = clampOrdered (x, -87.3f, 88.3f);
+
+        auto n = Vec::roundNearest (Vec::mul (x, Vec::broadcast (1.44269504088896341f)));
+        auto r = Vec::sub (Vec::sub (x, Vec::mul (n, Vec::broadcast (0.693359375f))),
+                           Vec::mul (n, Vec::broadcast (-2.12194440e-4f)));
+
+        auto p = Vec::broadcast (1.9875691500e-4f);
+        p = Vec::add (Vec::mul (p, r), Vec::broadcast (1.3981999507e-3f));
+        p = Vec::add (Vec::mul (p, r), Vec::broadcast (8.3334519073e-3f));
+        p = Vec::add (Vec::mul (p, r), Vec::broadcast (4.1665795894e-2f));
+        p = Vec::add (Vec::mul (p, r), Vec::broadcast (1.6666665459e-1f));
+        p = Vec::add (Vec::mul (p, r), Vec::broadcast (5.0000001201e-1f));
+
+        auto y = Vec::add (Vec::add (Vec::mul (Vec::mul (p, r), r), r), Vec::broadcast (1.0f));
+        return Vec::mul (y, Vec::pow2 (n));
+    }
+}
+
+//==============================================================================
+/*  Branch-free versions of the transfer functions in FuzzShapers.h. Each one
+    decodes the fuzz amount into whatever constants it needs up front.
+*/
+struct BlackShaper
+{
+    explicit BlackShaper (float fuzz) noexcept
+        : _fuzz (Vec::broadcast (fuzz)), _negFuzz (Vec::broadcast (-fuzz))
+    {
+    }
+
+    // sign(x) * (1 - exp(-|x| * fuzz)), which is both branches of the original
+    V operator() (V x) const noexcept
+    {
+        auto e = fastExp (Vec::mul (Vec::abs (x), _negFuzz));
+        return Vec::copySign (Vec::sub (Vec::broadcast (Sample (1)), e), x);
+    }
+
+    // |x| * (1 - (1 - exp(-v)) / v) with v = |x| * fuzz, switching to the
+    // Taylor series below v = 1 where the closed form starts to cancel. In
+    // double the cancellation doesn't matter until much lower, and switching
+    // at v = 1/8 keeps the series' truncation error down with it.
+    V antiderivative (V x) const noexcept
+    {
+        const auto seriesLimit = Vec::broadcast (std::is_same<Sample, double>::value ? Sample (0.125) : Sample (1));
+
+        auto a = Vec::abs (x);
+        auto v = Vec::mul (a, _fuzz);
+        auto e = fastExp (Vec::sub (Vec::broadcast (Sample (0)), v));
+        auto closed = Vec::sub (Vec::broadcast (Sample (1)), Vec::div (Vec::sub (Vec::broadcast (Sample (1)), e), v));
+
+        // v/2! - v^2/3! + v^3/4! - ... to v^10/11!
+        auto series = Vec::broadcast (Sample (1) / 39916800);
+
+        for (auto d : { 3628800, 362880, 40320, 5040, 720, 120, 24, 6, 2 })
+            series = Vec::sub (Vec::broadcast (Sample (1) / d), Vec::mul (series, v));
+
+        series = Vec::mul (series, v);
+
+        return Vec::mul (a, Vec::select (Vec::lessThan (v, seriesLimit), series, closed));
+    }
+
+    V _fuzz, _negFuzz;
+};
+
+struct WhiteShaper
+{
+    explicit WhiteShaper (float fuzz) noexcept
+        : _k (Vec::broadcast (6 * (Sample (fuzz) / 30)))
+    {
+    }
+
+    V operator() (V x) const noexcept
+    {
+        const auto one = Vec::broadcast (Sample (1));
+        const auto two = Vec::broadcast (Sample (2));
+        const auto three = Vec::broadcast (Sample (3));
+        const auto threshold = Vec::broadcast (Sample (1) / 3);
+        const auto twoThresholds = Vec::broadcast (2 * (Sample (1) / 3));
+        const auto zero = Vec::broadcast (Sample (0));
+
+        auto d = Vec::sub (two, Vec::mul (_k, x));
+        auto q = Vec::div (Vec::sub (three, Vec::mul (d, d)), three);
+
+        auto y = Vec::select (Vec::lessThan (x, Vec::sub (zero, threshold)), Vec::sub (zero, q), Vec::mul (x, two));
+        y = Vec::select (Vec::greaterThan (x, threshold), q, y);
+        y = Vec::select (Vec::greaterThan (x, twoThresholds), one, y);
+        y = Vec::select (Vec::lessThan (x, Vec::sub (zero, twoThresholds)), Vec::sub (zero, one), y);
+
+        return Vec::mul (y, Vec::broadcast (Sample (0.5)));
+    }
+
+    // Piecewise: x^2 / 2 in the middle, and from +/-1/3 outwards the integral
+    // of the quadratic, written as (x - x0) * (1/2 - (a^2 + ab + b^2) / 18)
+    // with a = 2 - kx, b = 2 - k x0 so that it stays finite as fuzz -> 0.
+    // Beyond +/-2/3 it continues with slope +/-1/2.
+    V antiderivative (V x) const noexcept
+    {
+        const auto half = Vec::broadcast (Sample (0.5));
+        const auto two = Vec::broadcast (Sample (2));
+        const auto t = Vec::broadcast (Sample (1) / 3);
+        const auto negT = Vec::broadcast (Sample (-1) / 3);
+        const auto twoT = Vec::broadcast (2 * (Sample (1) / 3));
+        const auto negTwoT = Vec::broadcast (-2 * (Sample (1) / 3));
+        const auto base = Vec::mul (half, Vec::mul (t, t));
+
+        auto slope = [half] (V a, V b) noexcept
+        {
+            auto sum = Vec::add (Vec::add (Vec::mul (a, a), Vec::mul (a, b)), Vec::mul (b, b));
+            return Vec::sub (half, Vec::mul (sum, Vec::broadcast (Sample (1) / 18)));
+        };
+
+        auto bPos = Vec::sub (two, Vec::mul (_k, t));
+        auto bNeg = Vec::sub (two, Vec::mul (_k, negT));
+
+        auto inner = Vec::mul (half, Vec::mul (x, x));
+
+        auto xPos = Vec::min (x, twoT);
+        auto upper = Vec::add (base, Vec::mul (Vec::sub (xPos, t), slope (Vec::sub (two, Vec::mul (_k, xPos)), bPos)));
+        upper = Vec::add (upper, Vec::mul (half, Vec::max (Vec::sub (x, twoT), Vec::broadcast (Sample (0)))));
+
+        auto xNeg = Vec::max (x, negTwoT);
+        auto lower = Vec::sub (base, Vec::mul (Vec::sub (xNeg, negT), slope (Vec::sub (two, Vec::mul (_k, xNeg)), bNeg)));
+        lower = Vec::sub (lower, Vec::mul (half, Vec::min (Vec::sub (x, negTwoT), Vec::broadcast (Sample (0)))));
+
+        auto y = Vec::select (Vec::greaterThan (x, t), upper, inner);
+        return Vec::select (Vec::lessThan (x, negT), lower, y);
+    }
+
+    V _k;
+};
+
+struct RedShaper
+{
+    explicit RedShaper (float fuzz) noexcept
+        : _threshold (Vec::broadcast (1 - Sample (fuzz) / 30)),
+          _negThreshold (Vec::broadcast (-(1 - Sample (fuzz) / 30)))
+    {
+    }
+
+    V operator() (V x) const noexcept
+    {
+        auto y = Vec::select (Vec::lessThan (x, _negThreshold), Vec::broadcast (-Sample (1)), x);
+        return Vec::select (Vec::greaterThan (x, _threshold), Vec::broadcast (Sample (1)), y);
+    }
+
+    // x^2 / 2 inside the threshold, |x| - t + t^2 / 2 outside it
+    V antiderivative (V x) const noexcept
+    {
+        auto a = Vec::abs (x);
+        auto inside = Vec::mul (Vec::broadcast (Sample (0.5)), Vec::mul (x, x));
+        auto outside = Vec::add (Vec::sub (a, _threshold), Vec::mul (Vec::broadcast (Sample (0.5)), Vec::mul (_threshold, _threshold)));
+        return Vec::select (Vec::greaterThan (a, _threshold), outside, inside);
+    }
+
+    V _threshold, _negThreshold;
+};
+
+//==============================================================================
+/** Applies gain, the shaper and volume to one vector whose first lane is
+    sample number index of the segment, then blends the result with the
+    input by mix unless the kernel is fully wet.
+*/
+template <bool Ramped, bool Mixed, typename Shaper>
+inline V processVector (const Shaper& shaper, V x, int index, Ramp gain, Ramp volume, Ramp mix) noexcept
+{
+    auto g = Vec::broadcast (gain.start);
+    auto v = Vec::broadcast (volume.start);
+    auto m = Vec::broadcast (mix.start);
+
+    if (Ramped)
+    {
+        auto i = Vec::add (Vec::broadcast ((float) index), Vec::lanes());
+        g = Vec::add (g, Vec::mul (i, Vec::broadcast (gain.step)));
+        v = Vec::add (v, Vec::mul (i, Vec::broadcast (volume.step)));
+        m = Vec::add (m, Vec::mul (i, Vec::broadcast (mix.step)));
+    }
+
+    auto y = Vec::mul (shaper (Vec::mul (x, g)), v);
+
+    if (Mixed)
+        y = Vec::add (x, Vec::mul (Vec::sub (y, x), m));
+
+    return y;
+}
+
+/** Runs fewer than Vec::size samples through a zero-padded aligned scratch
+    vector, so heads and tails get exactly the same maths as the body.
+*/
+template <bool Ramped, bool Mixed, typename Shaper>
+inline void processPartial (const Shaper& shaper, Sample* data, int count, int index, Ramp gain, Ramp volume, Ramp mix) noexcept
+{
+    alignas (Vec::alignment) Sample scratch[Vec::size] = {};
+
+    for (int i = 0; i < count; ++i)
+        scratch[i] = data[i];
+
+    Vec::storeAligned (scratch, processVector<Ramped, Mixed> (shaper, Vec::loadAligned (scratch), index, gain, volume, mix));
+
+    for (int i = 0; i < count; ++i)
+        data[i] = scratch[i];
+}
+
+template <bool Ramped, bool Mixed, typename Shaper>
+inline void processSegment (const Shaper& shaper, Sample* data, int numSamples, Ramp gain, Ramp volume, Ramp mix) noexcept
+{
+    // unaligned head, up to the first aligned vector
+    auto misalignment = (int) (reinterpret_cast<std::uintptr_t> (data) % (std::uintptr_t) Vec::alignment);
+    auto head = std::min (numSamples, misalignment == 0 ? 0 : (Vec::alignment - misalignment) / (int) sizeof (Sample));
+
+    if (head > 0)
+        processPartial<Ramped, Mixed> (shaper, data, head, 0, gain, volume, mix);
+
+    int i = head;
+
+    for (; i + Vec::size <= numSamples; i += Vec::size)
+        Vec::storeAligned (data + i, processVector<Ramped, Mixed> (shaper, Vec::loadAligned (data + i), i, gain, volume, mix));
+
+    // tail
+    if (i < numSamples)
+        processPartial<Ramped, Mixed> (shaper, data + i, numSamples - i, i, gain, volume, mix);
+}
+
+/** True when mix leaves nothing of the input, so the blend can be skipped
+    and a fully wet kernel is exactly what it was before mix existed.
+*/
+inline bool isFullyWet (Ramp mix) noexcept
+{
+    return mix.isConstant() && mix.start == 1.0f;
+}
+
+template <typename Shaper>
+inline void processWith (const Shaper& shaper, Sample* data, int numSamples, Ramp gain, Ramp volume, Ramp mix) noexcept
+{
+    auto ramped = ! (gain.isConstant() && volume.isConstant() && mix.isConstant());
+
+    if (isFullyWet (mix))
+    {
+        if (ramped)
+            processSegment<true, false> (shaper, data, numSamples, gain, volume, mix);
+        else
+            processSegment<false, false> (shaper, data, numSamples, gain, volume, mix);
+    }
+    else
+    {
+        if (ramped)
+            processSegment<true, true> (shaper, data, numSamples, gain, volume, mix);
+        else
+            processSegment<false, true> (shaper, data, numSamples, gain, volume, mix);
+    }
+}
+
+/** processSegment() for several channels in one pass. Each vector of gain,
+    volume and mix is worked out once and applied to the same samples of
+    every channel, so stereo pays for one ramp and one loop rather than two.
+    Channels needn't share an alignment, so the body loads unaligned.
+*/
+template <bool Ramped, bool Mixed, typename Shaper>
+inline void processChannelsSegment (const Shaper& shaper, Sample* const* channels, int numChannels,
+                                    int startSample, int numSamples, Ramp gain, Ramp volume, Ramp mix) noexcept
+{
+    int i = 0;
+
+    for (; i + Vec::size <= numSamples; i += Vec::size)
+    {
+        auto g = Vec::broadcast (gain.start);
+        auto v = Vec::broadcast (volume.start);
+        auto m = Vec::broadcast (mix.start);
+
+        if (Ramped)
+        {
+            auto index = Vec::add (Vec::broadcast ((float) i), Vec::lanes());
+            g = Vec::add (g, Vec::mul (index, Vec::broadcast (gain.step)));
+            v = Vec::add (v, Vec::mul (index, Vec::broadcast (volume.step)));
+            m = Vec::add (m, Vec::mul (index, Vec::broadcast (mix.step)));
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = channels[channel] + startSample + i;
+            auto x = Vec::load (data);
+            auto y = Vec::mul (shaper (Vec::mul (x, g)), v);
+
+            if (Mixed)
+                y = Vec::add (x, Vec::mul (Vec::sub (y, x), m));
+
+            Vec::store (data, y);
+        }
+    }
+
+    // tail
+    if (i < numSamples)
+        for (int channel = 0; channel < numChannels; ++channel)
+            processPartial<Ramped, Mixed> (shaper, channels[channel] + startSample + i, numSamples - i, i, gain, volume, mix);
+}
+
+template <typename Shaper>
+inline void processChannelsWith (const Shaper& shaper, Sample* const* channels, int numChannels,
+                                 int startSample, int numSamples, Ramp gain, Ramp volume, Ramp mix) noexcept
+{
+    auto ramped = ! (gain.isConstant() && volume.isConstant() && mix.isConstant());
+
+    if (isFullyWet (mix))
+    {
+        if (ramped)
+            processChannelsSegment<true, false> (shaper, channels, numChannels, startSample, numSamples, gain, volume, mix);
+        else
+            processChannelsSegment<false, false> (shaper, channels, numChannels, startSample, numSamples, gain, volume, mix);
+    }
+    else
+    {
+        if (ramped)
+            processChannelsSegment<true, true> (shaper, channels, numChannels, startSample, numSamples, gain, volume, mix);
+        else
+            processChannelsSegment<false, true> (shaper, channels, numChannels, startSample, numSamples, gain, volume, mix);
+    }
+}
+
+//==============================================================================
+template <FuzzMode Mode> struct ShaperFor;
+template <> struct ShaperFor<FuzzMode::Black>   { using Type = BlackShaper; };
+template <> struct ShaperFor<FuzzMode::White>   { using Type = WhiteShaper; };
+template <> struct ShaperFor<FuzzMode::Red>     { using Type = RedShaper; };
+
+/** Processes numSamples samples of one channel in place. The mode is fixed
+    at compile time, so each one is its own straight-line loop.
+*/
+template <FuzzMode Mode>
+void processMode (Sample* data, int numSamples, Ramp gain, Ramp volume, Ramp mix, float fuzz) noexcept
+{
+    processWith (typename ShaperFor<Mode>::Type (fuzz), data, numSamples, gain, volume, mix);
+}
+
+/** processMode() for numChannels channels at once, from startSample. */
+template <FuzzMode Mode>
+void processModeChannels (Sample* const* channels, int numChannels, int startSample, int numSamples,
+                          Ramp gain, Ramp volume, Ramp mix, float fuzz) noexcept
+{
+    processChannelsWith (typename ShaperFor<Mode>::Type (fuzz), channels, numChannels, startSample, numSamples, gain, volume, mix);
+}
+
+//==============================================================================
+/** processMode() with first-order antiderivative anti-aliasing.
+
+    Works through the block in chunks: the inputs after gain go into a
+    scratch buffer behind the previous block's last one, the shaper and its
+    antiderivative are taken of all of them in one pass, and each output
+    then reads the pair it needs with an unaligned load one sample back.
+    The previous input is reshaped rather than carried over, so a change of
+    fuzz or mode between blocks can't leave a stale value behind.
+
+    The fallback for close inputs is the mean of the two shaped values
+    rather than the shaper at their midpoint: it's as accurate on the
+    smooth parts, and it still lands halfway up Red mode's step when the
+    two straddle the clipping threshold.
+
+    ADAA's output sits half a sample behind its input, so when mixing the
+    dry side is the mean of this input and the last one, which keeps the
+    two sides in phase right up to Nyquist.
+*/
+template <FuzzMode Mode>
+void processModeAdaa (Sample* data, int numSamples, Ramp gain, Ramp volume, Ramp mix, float fuzz, AdaaState& state) noexcept
+{
+    const typename ShaperFor<Mode>::Type shaper (fuzz);
+    constexpr int chunkSize = 64;
+
+    // x[0] and dry[0] are the previous input, and each buffer has room to
+    // round up to whole vectors past the end of the chunk
+    alignas (Vec::alignment) Sample x[chunkSize + 2 * Vec::size];
+    alignas (Vec::alignment) Sample dry[chunkSize + 2 * Vec::size];
+    alignas (Vec::alignment) Sample shaped[chunkSize + 2 * Vec::size];
+    alignas (Vec::alignment) Sample antiderivative[chunkSize + 2 * Vec::size];
+
+    const auto tolerance = Vec::broadcast (getAdaaTolerance<Sample>());
+    const auto half = Vec::broadcast (Sample (0.5));
+    const auto mixed = ! isFullyWet (mix);
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        const auto count = std::min (chunkSize, numSamples - start);
+
+        x[0] = (Sample) state.lastInput;
+        dry[0] = (Sample) state.lastDry;
+
+        for (int i = 0; i < count; ++i)
+        {
+            dry[i + 1] = data[start + i];
+            x[i + 1] = dry[i + 1] * (Sample (gain.start) + Sample (gain.step) * (Sample) (start + i));
+        }
+
+        for (int i = count + 1; i < count + 1 + Vec::size; ++i)
+            x[i] = dry[i] = 0;
+
+        for (int i = 0; i <= count; i += Vec::size)
+        {
+            auto in = Vec::loadAligned (x + i);
+            Vec::storeAligned (shaped + i, shaper (in));
+            Vec::storeAligned (antiderivative + i, shaper.antiderivative (in));
+        }
+
+        // each output overwrites the shaped value it has just finished with
+        for (int i = 0; i < count; i += Vec::size)
+        {
+            auto previous = Vec::loadAligned (x + i);
+            auto current = Vec::load (x + i + 1);
+            auto dx = Vec::sub (current, previous);
+
+            auto quotient = Vec::div (Vec::sub (Vec::load (antiderivative + i + 1), Vec::loadAligned (antiderivative + i)), dx);
+            auto mean = Vec::mul (Vec::add (Vec::load (shaped + i + 1), Vec::loadAligned (shaped + i)), half);
+            auto scale = Vec::max (Vec::abs (previous), Vec::abs (current));
+            auto y = Vec::select (Vec::greaterThan (Vec::abs (dx), Vec::mul (scale, tolerance)), quotient, mean);
+
+            auto index = Vec::add (Vec::broadcast ((float) (start + i)), Vec::lanes());
+            auto v = Vec::add (Vec::broadcast (volume.start), Vec::mul (index, Vec::broadcast (volume.step)));
+            y = Vec::mul (y, v);
+
+            if (mixed)
+            {
+                auto d = Vec::mul (Vec::add (Vec::loadAligned (dry + i), Vec::load (dry + i + 1)), half);
+                auto m = Vec::add (Vec::broadcast (mix.start), Vec::mul (index, Vec::broadcast (mix.step)));
+                y = Vec::add (d, Vec::mul (Vec::sub (y, d), m));
+            }
+
+            Vec::storeAligned (shaped + i, y);
+        }
+
+        state.lastInput = x[count];
+        state.lastDry = dry[count];
+
+        for (int i = 0; i < count; ++i)
+            data[start + i] = shaped[i];
+    }
+}
+
+//==============================================================================
+/** The largest |sample|. Scalar up to the first aligned vector and after the
+    last one, a running vector max in between.
+*/
+inline Sample findPeak (const Sample* data, int numSamples) noexcept
+{
+    Sample peak = 0;
+    int i = 0;
+
+    for (; i < numSamples && reinterpret_cast<std::uintptr_t> (data + i) % (std::uintptr_t) Vec::alignment != 0; ++i)
+        peak = std::max (peak, std::abs (data[i]));
+
+    auto peaks = Vec::broadcast (Sample (0));
+
+    for (; i + Vec::size <= numSamples; i += Vec::size)
+        peaks = Vec::max (peaks, Vec::abs (Vec::loadAligned (data + i)));
+
+    for (; i < numSamples; ++i)
+        peak = std::max (peak, std::abs (data[i]));
+
+    alignas (Vec::alignment) Sample lanes[Vec::size];
+    Vec::storeAligned (lanes, peaks);
+
+    for (auto lane : lanes)
+        peak = std::max (peak, lane);
+
+    return peak;
+}
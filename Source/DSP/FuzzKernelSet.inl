@@ -0,0 +1,39 @@
+/*
+  ==============================================================================
+
+    FuzzKernelSet.inl
+    One instruction set's kernels in float and double, and its table.
+
+    FuzzKernels.h includes this file once per instruction set, inside that
+    instruction set's namespace and target region, with its Vec and
+    VecDouble already in scope. Don't include it anywhere else.
+
+  ==============================================================================
+*/
+
+namespace f32
+{
+    #include "FuzzKernelBody.inl"
+    #include "BlackTableKernelBody.inl"
+}
+
+namespace f64
+{
+    using Vec = VecDouble;
+
+    #include "FuzzKernelBody.inl"
+}
+
+inline FuzzKernelTable makeKernelTable (InstructionSet isa) noexcept
+{
+    return { isa,
+             { { f32::processMode<FuzzMode::Black>, f32::processMode<FuzzMode::White>, f32::processMode<FuzzMode::Red> },
+               { f32::processModeChannels<FuzzMode::Black>, f32::processModeChannels<FuzzMode::White>, f32::processModeChannels<FuzzMode::Red> },
+               { f32::processModeAdaa<FuzzMode::Black>, f32::processModeAdaa<FuzzMode::White>, f32::processModeAdaa<FuzzMode::Red> },
+               f32::findPeak },
+             { { f64::processMode<FuzzMode::Black>, f64::processMode<FuzzMode::White>, f64::processMode<FuzzMode::Red> },
+               { f64::processModeChannels<FuzzMode::Black>, f64::processModeChannels<FuzzMode::White>, f64::processModeChannels<FuzzMode::Red> },
+               { f64::processModeAdaa<FuzzMode::Black>, f64::processModeAdaa<FuzzMode::White>, f64::processModeAdaa<FuzzMode::Red> },
+               f64::findPeak },
+             { f32::processBlackTable<Interpolation::Linear>, f32::processBlackTable<Interpolation::Cubic> } };
+}
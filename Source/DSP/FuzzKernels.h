@@ -0,0 +1,234 @@
+/*
+  ==============================================================================
+
+    FuzzKernels.h
+    Vectorised gain -> shaper -> volume kernels for every instruction set
+    this build knows about, and the table the processor picks them from.
+
+    Every kernel matches the reference transfer functions in FuzzShapers.h
+    to within 1e-6 * max (1, |reference|) for any gain, volume and fuzz in
+    range. The difference comes from the polynomial exp in Black mode and
+    from rounding order (and FMA contraction on AVX2) elsewhere. The ADAA
+    kernels are within 1e-4 of exact first-order ADAA of the same curves.
+
+    Every kernel except the table ones also comes in double, which does the
+    same maths at double precision all the way through rather than
+    converting to float and back.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+#include "CpuFeatures.h"
+#include "FuzzParameters.h"
+#include "LinearSmoother.h"
+#include "WaveshaperTable.h"
+#include "Simd/SimdTarget.h"
+#include "Simd/VecScalar.h"
+#include "Simd/VecSSE2.h"
+#include "Simd/VecAVX2.h"
+#include "Simd/VecAVX512.h"
+#include "Simd/VecNEON.h"
+
+namespace pandamonium
+{
+
+//==============================================================================
+/** Processes numSamples samples of one channel in place. The output is
+    input + mix * (shaped - input), so a mix of 1 is fully wet; the kernels
+    skip the blend altogether when it's a constant 1.
+*/
+template <typename Sample>
+using FuzzKernelFor = void (*) (Sample* data, int numSamples, Ramp gain, Ramp volume, Ramp mix, float fuzz) noexcept;
+
+using FuzzKernel = FuzzKernelFor<float>;
+
+/** As FuzzKernel, for samples startSample to startSample + numSamples of
+    numChannels channels at once, sharing the ramps between them.
+*/
+template <typename Sample>
+using FuzzChannelsKernelFor = void (*) (Sample* const* channels, int numChannels, int startSample, int numSamples,
+                                        Ramp gain, Ramp volume, Ramp mix, float fuzz) noexcept;
+
+/** As FuzzKernel, with the shaper read from a lookup table. Float only. */
+using FuzzTableKernel = void (*) (float* data, int numSamples, Ramp gain, Ramp volume, Ramp mix, float fuzz,
+                                  const WaveshaperTable& table) noexcept;
+
+/** What an anti-aliased kernel carries from one block to the next for one
+    channel: the last sample after gain, and before it for the dry side of
+    the mix. Zero it when the channel restarts.
+*/
+struct AdaaState
+{
+    double lastInput = 0.0;
+    double lastDry = 0.0;
+};
+
+/** As FuzzKernel, with first-order antiderivative anti-aliasing (ADAA).
+
+    Each output is the mean of the shaper over the line from the previous
+    input to this one, (F(x[n]) - F(x[n-1])) / (x[n] - x[n-1]) with F the
+    shaper's closed-form antiderivative. The antiderivatives are never much
+    bigger than |x|, so where the inputs differ by less than
+    getAdaaTolerance() times the larger of them that quotient is mostly
+    rounding error, and the mean of the two shaped values is used instead.
+    Costs half a sample of delay, which the dry side of the mix gets too.
+*/
+template <typename Sample>
+using FuzzAdaaKernelFor = void (*) (Sample* data, int numSamples, Ramp gain, Ramp volume, Ramp mix, float fuzz,
+                                    AdaaState& state) noexcept;
+
+using FuzzAdaaKernel = FuzzAdaaKernelFor<float>;
+
+/** The relative input step below which ADAA falls back to the mean. Double
+    cancels so much less that it can get a lot closer before it has to.
+*/
+template <typename Sample>
+constexpr Sample getAdaaTolerance() noexcept
+{
+    return std::is_same<Sample, double>::value ? Sample (1.0e-6) : Sample (1.0e-3);
+}
+
+/** The largest |sample| in numSamples samples, for silence detection. */
+template <typename Sample>
+using PeakFunctionFor = Sample (*) (const Sample* data, int numSamples) noexcept;
+
+/** The kernels for one instruction set in one precision. */
+template <typename Sample>
+struct FuzzKernelSet
+{
+    FuzzKernelFor<Sample> process[numFuzzModes];
+    FuzzChannelsKernelFor<Sample> processChannels[numFuzzModes];
+    FuzzAdaaKernelFor<Sample> adaa[numFuzzModes];
+    PeakFunctionFor<Sample> findPeak;
+};
+
+/** The kernels for one instruction set, one per mode and precision. Only
+    ever call these through a table from getFuzzKernels(), which makes sure
+    the CPU can run them.
+*/
+struct FuzzKernelTable
+{
+    InstructionSet instructionSet;
+    FuzzKernelSet<float> floatKernels;
+    FuzzKernelSet<double> doubleKernels;
+    FuzzTableKernel blackTable[numInterpolations];
+
+    template <typename Sample>
+    const FuzzKernelSet<Sample>& getSet() const noexcept
+    {
+        if constexpr (std::is_same<Sample, double>::value)
+            return doubleKernels;
+        else
+            return floatKernels;
+    }
+
+    template <typename Sample = float>
+    FuzzKernelFor<Sample> get (FuzzMode mode) const noexcept                { return getSet<Sample>().process[(int) mode]; }
+
+    template <typename Sample = float>
+    FuzzChannelsKernelFor<Sample> getForChannels (FuzzMode mode) const noexcept  { return getSet<Sample>().processChannels[(int) mode]; }
+
+    template <typename Sample = float>
+    FuzzAdaaKernelFor<Sample> getAdaa (FuzzMode mode) const noexcept        { return getSet<Sample>().adaa[(int) mode]; }
+
+    FuzzTableKernel getBlackTable (Interpolation interpolation) const noexcept  { return blackTable[(int) interpolation]; }
+
+    template <typename Sample>
+    Sample findPeak (const Sample* data, int numSamples) const noexcept     { return getSet<Sample>().findPeak (data, numSamples); }
+};
+
+} // namespace pandamonium
+
+namespace pandamonium
+{
+namespace scalar
+{
+    #include "FuzzKernelSet.inl"
+}
+}
+
+#if PANDAMONIUM_X86
+PANDAMONIUM_TARGET_BEGIN_SSE2
+namespace pandamonium
+{
+namespace sse2
+{
+    #include "FuzzKernelSet.inl"
+}
+}
+PANDAMONIUM_TARGET_END
+
+PANDAMONIUM_TARGET_BEGIN_AVX2
+namespace pandamonium
+{
+namespace avx2
+{
+    #include "FuzzKernelSet.inl"
+}
+}
+PANDAMONIUM_TARGET_END
+
+PANDAMONIUM_TARGET_BEGIN_AVX512
+namespace pandamonium
+{
+namespace avx512
+{
+    #include "FuzzKernelSet.inl"
+}
+}
+PANDAMONIUM_TARGET_END
+#endif
+
+#if PANDAMONIUM_NEON
+namespace pandamonium
+{
+namespace neon
+{
+    #include "FuzzKernelSet.inl"
+}
+}
+#endif
+
+namespace pandamonium
+{
+
+/** Returns the kernels for isa, or the scalar ones if this build or this
+    CPU can't run isa.
+*/
+inline const FuzzKernelTable& getFuzzKernels (InstructionSet isa) noexcept
+{
+    static const FuzzKernelTable scalarKernels = scalar::makeKernelTable (InstructionSet::Scalar);
+
+    if (! isInstructionSetSupported (isa))
+        return scalarKernels;
+
+    switch (isa)
+    {
+       #if PANDAMONIUM_X86
+        case InstructionSet::SSE2:      { static const auto t = sse2::makeKernelTable (isa); return t; }
+        case InstructionSet::AVX2:      { static const auto t = avx2::makeKernelTable (isa); return t; }
+        case InstructionSet::AVX512:    { static const auto t = avx512::makeKernelTable (isa); return t; }
+       #endif
+       #if PANDAMONIUM_NEON
+        case InstructionSet::NEON:      { static const auto t = neon::makeKernelTable (isa); return t; }
+       #endif
+        default:                        break;
+    }
+
+    return scalarKernels;
+}
+
+/** The kernels for getPreferredInstructionSet(). */
+inline const FuzzKernelTable& getPreferredFuzzKernels() noexcept
+{
+    return getFuzzKernels (getPreferredInstructionSet());
+}
+
+} // namespace pandamonium
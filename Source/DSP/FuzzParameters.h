@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    FuzzParameters.h
+    A per-block snapshot of the plugin parameters in the units the DSP uses.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+namespace pandamonium
+{
+
+//==============================================================================
+enum class FuzzMode
+{
+    Black = 0,  // exponential soft clip
+    White,      // piecewise quadratic
+    Red         // hard clip
+};
+
+constexpr int numFuzzModes = 3;
+
+/** Maps the raw "mode" parameter value onto a FuzzMode the same way the
+    original per-sample comparisons did: 0 is Black, 1 is White, anything
+    else is Red.
+*/
+inline FuzzMode modeFromParameter (float value) noexcept
+{
+    if (value == 0.0f)
+        return FuzzMode::Black;
+
+    if (value == 1.0f)
+        return FuzzMode::White;
+
+    return FuzzMode::Red;
+}
+
+inline float decibelsToGain (float decibels) noexcept
+{
+    return std::pow (10.0f, decibels / 20.0f);
+}
+
+//==============================================================================
+/** Every parameter decoded once, at the start of a block. */
+struct FuzzParameters
+{
+    float gain = 1.0f;      // linear
+    float fuzz = 15.0f;     // 0 - 30, as on the knob
+    float volume = 1.0f;    // linear
+    FuzzMode mode = FuzzMode::Black;
+    float mix = 1.0f;       // 0 (dry) - 1 (wet)
+
+    /** Decodes the raw parameter values (gain and volume in decibels, mix
+        in percent).
+    */
+    static FuzzParameters fromRaw (float gainDecibels, float fuzz, float volumeDecibels, float mode,
+                                   float mixPercent = 100.0f) noexcept
+    {
+        FuzzParameters p;
+        p.gain = decibelsToGain (gainDecibels);
+        p.fuzz = fuzz;
+        p.volume = decibelsToGain (volumeDecibels);
+        p.mode = modeFromParameter (mode);
+        p.mix = std::min (std::max (mixPercent / 100.0f, 0.0f), 1.0f);
+        return p;
+    }
+};
+
+} // namespace pandamonium
@@ -0,0 +1,391 @@
+/*
+  ==============================================================================
+
+    FuzzProcessor.h
+    The whole fuzz, from gain to volume, on plain channel pointers.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "FuzzKernels.h"
+#include "FuzzParameters.h"
+#include "LinearSmoother.h"
+#include "Oversampler.h"
+#include "SilenceDetection.h"
+#include "WaveshaperTable.h"
+
+#if PANDAMONIUM_X86 && (defined (__SSE__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 1))
+ #include <xmmintrin.h>
+ #define PANDAMONIUM_FLUSH_DENORMALS_SSE 1
+#else
+ #define PANDAMONIUM_FLUSH_DENORMALS_SSE 0
+#endif
+
+namespace pandamonium
+{
+
+//==============================================================================
+/** Treats denormals as zero on this thread for as long as it lives, so
+    filters decaying into silence don't crawl. The plugin gets this from
+    juce::ScopedNoDenormals; anything else calling FuzzProcessor gets it
+    from here.
+*/
+class ScopedFlushDenormals
+{
+public:
+    ScopedFlushDenormals() noexcept
+    {
+       #if PANDAMONIUM_FLUSH_DENORMALS_SSE
+        _previous = _mm_getcsr();
+        _mm_setcsr (_previous | 0x8040);    // flush to zero, denormals are zero
+       #elif PANDAMONIUM_NEON && (defined (__GNUC__) || defined (__clang__))
+        asm volatile ("mrs %0, fpcr" : "=r" (_previous));
+        std::uint64_t flushing = _previous | (1ull << 24);
+        asm volatile ("msr fpcr, %0" : : "r" (flushing));
+       #endif
+    }
+
+    ~ScopedFlushDenormals() noexcept
+    {
+       #if PANDAMONIUM_FLUSH_DENORMALS_SSE
+        _mm_setcsr (_previous);
+       #elif PANDAMONIUM_NEON && (defined (__GNUC__) || defined (__clang__))
+        asm volatile ("msr fpcr, %0" : : "r" (_previous));
+       #endif
+    }
+
+    ScopedFlushDenormals (const ScopedFlushDenormals&) = delete;
+    ScopedFlushDenormals& operator= (const ScopedFlushDenormals&) = delete;
+
+private:
+   #if PANDAMONIUM_FLUSH_DENORMALS_SSE
+    unsigned int _previous = 0;
+   #else
+    std::uint64_t _previous = 0;
+   #endif
+};
+
+//==============================================================================
+/**
+    Gain, the three fuzz modes, volume and mix, with their smoothing,
+    oversampling, ADAA and silence skipping, on whatever channels it's
+    given. Nothing here knows about JUCE, hosts or parameter trees: the
+    plugin is one caller, and a render engine can be another.
+
+    prepare() allocates everything; after that process() and every setter
+    are realtime safe, never allocating, locking or throwing. One instance
+    keeps the state of one stream, so give each stream its own, and call it
+    from one thread at a time.
+
+    Sample is float or double, and double runs the kernels and the
+    oversampling filters in double all the way through.
+*/
+template <typename Sample>
+class FuzzProcessor
+{
+public:
+    /** How long a gain, volume or mix change takes to settle. */
+    static constexpr double defaultSmoothingSeconds = 0.02;
+
+    static constexpr int maxOversamplingStages = Oversampler<Sample>::maxStages;
+
+    /** Uses kernels for the fuzz, or the fastest ones this CPU can run. */
+    explicit FuzzProcessor (const FuzzKernelTable& kernels = getPreferredFuzzKernels()) noexcept
+        : _kernels (&kernels)
+    {
+    }
+
+    /** Allocates for blocks of up to maxBlockSize samples of up to
+        numChannels channels, and starts from silence at the current
+        parameters. Not realtime safe.
+    */
+    void prepare (double sampleRate, int maxBlockSize, int numChannels, double smoothingSeconds = defaultSmoothingSeconds)
+    {
+        _maxBlockSize = std::max (1, maxBlockSize);
+        _numChannels = std::max (1, numChannels);
+
+        _gainSmoother.reset (sampleRate, smoothingSeconds);
+        _volumeSmoother.reset (sampleRate, smoothingSeconds);
+        _mixSmoother.reset (sampleRate, smoothingSeconds);
+
+        _oversampler.prepare (_numChannels, _maxBlockSize);
+        _adaaStates.assign ((size_t) _numChannels, {});
+        _block.resize ((size_t) _numChannels);
+
+        reset();
+    }
+
+    /** Frees everything prepare() allocated. */
+    void release()
+    {
+        _oversampler.release();
+        _adaaStates = {};
+        _block = {};
+        _maxBlockSize = 0;
+    }
+
+    /** Forgets the stream so far: the filters and ADAA start from silence
+        and the ramps jump to their targets.
+    */
+    void reset() noexcept
+    {
+        _oversampler.reset();
+        snapToTargets();
+        _adaaActive = false;
+        _silentSamples = 0;
+        _skipping = false;
+    }
+
+    //==============================================================================
+    /** New values for every parameter. Gain, volume and mix ramp to theirs
+        over the smoothing time; mode and fuzz change at the next process().
+    */
+    void setParameters (const FuzzParameters& parameters) noexcept
+    {
+        _parameters = parameters;
+
+        _gainSmoother.setTarget (parameters.gain);
+        _volumeSmoother.setTarget (parameters.volume);
+        _mixSmoother.setTarget (parameters.mix);
+    }
+
+    const FuzzParameters& getParameters() const noexcept    { return _parameters; }
+
+    /** 0 to 3 stages for 1x, 2x, 4x or 8x. The filters start from silence
+        whenever this changes, and getLatencySamples() follows it.
+    */
+    void setOversampling (int numStages, OversamplingFilter filter) noexcept
+    {
+        auto stages = _oversampler.getNumStages();
+        _oversampler.setup (numStages, filter);
+
+        // the ADAA history was at the old rate
+        if (_oversampler.getNumStages() != stages)
+            _adaaActive = false;
+    }
+
+    int getOversamplingStages() const noexcept              { return _oversampler.getNumStages(); }
+    OversamplingFilter getOversamplingFilter() const noexcept    { return _oversampler.getFilter(); }
+
+    /** Switches first-order ADAA on or off. It takes over from the lookup
+        table, which has no antiderivative.
+    */
+    void setAntialiasing (bool shouldAntialias) noexcept    { _antialiasing = shouldAntialias; }
+    bool isAntialiasing() const noexcept                    { return _antialiasing; }
+
+    /** Makes Black mode read its curve from table rather than calling exp(),
+        or nullptr to go back. The table belongs to the caller and must stay
+        alive until it's swapped out. The tables only come in float, so a
+        double processor ignores it.
+    */
+    void setBlackModeTable (const WaveshaperTable* table) noexcept  { _blackModeTable = table; }
+
+    //==============================================================================
+    /** The delay the oversampling adds, in samples, or 0 before prepare(). */
+    int getLatencySamples() const noexcept          { return _oversampler.getLatencySamples(); }
+
+    /** The most delay any oversampling setting can add. */
+    int getMaxLatencySamples() const noexcept       { return _oversampler.getMaxLatencySamples(); }
+
+    /** How long the output can keep going after the input stops: as long
+        as the oversampling filters take to die away, measured from the
+        filters themselves, and one more for the previous input ADAA holds.
+    */
+    int getTailLengthSamples() const noexcept       { return _oversampler.getTailSamples() + 1; }
+
+    InstructionSet getInstructionSet() const noexcept   { return _kernels->instructionSet; }
+
+    //==============================================================================
+    /** Runs numSamples samples of numChannels channels through the fuzz in
+        place. Longer buffers than prepare() allowed for are taken a block
+        at a time, and any channels past its numChannels are left alone.
+
+        No mode makes sound from silence, so once whatever was still ringing
+        has played out a silent block skips everything and is just cleared.
+        Returns false if every block was skipped that way.
+    */
+    bool process (Sample* const* channels, int numChannels, int numSamples) noexcept
+    {
+        if (_maxBlockSize == 0)
+            return true;
+
+        ScopedFlushDenormals noDenormals;
+        numChannels = std::min (numChannels, _numChannels);
+        auto processed = false;
+
+        for (int start = 0; start < numSamples; start += _maxBlockSize)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                _block[(size_t) channel] = channels[channel] + start;
+
+            processed |= processBlock (_block.data(), numChannels, std::min (_maxBlockSize, numSamples - start));
+        }
+
+        return processed;
+    }
+
+private:
+    void snapToTargets() noexcept
+    {
+        _gainSmoother.setCurrentAndTarget (_parameters.gain);
+        _volumeSmoother.setCurrentAndTarget (_parameters.volume);
+        _mixSmoother.setCurrentAndTarget (_parameters.mix);
+    }
+
+    bool processBlock (Sample* const* channels, int numChannels, int numSamples) noexcept
+    {
+        if (isInputSilent (channels, numChannels, numSamples))
+        {
+            auto nothingRinging = _silentSamples >= getTailLengthSamples();
+            _silentSamples += numSamples;
+
+            if (nothingRinging)
+            {
+                // whatever's left in the filters is below silence, and
+                // mustn't come back when the sound does
+                if (! _skipping)
+                {
+                    _oversampler.reset();
+                    _adaaActive = false;
+                    _skipping = true;
+                }
+
+                snapToTargets();
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    std::fill (channels[channel], channels[channel] + numSamples, Sample (0));
+
+                return false;
+            }
+        }
+        else
+        {
+            _silentSamples = 0;
+        }
+
+        _skipping = false;
+
+        if (_oversampler.getNumStages() > 0)
+        {
+            auto* upsampled = _oversampler.upsample (channels, numChannels, numSamples);
+            applyFuzz (upsampled, numChannels, numSamples, _oversampler.getFactor());
+            _oversampler.downsample (channels, numChannels, numSamples);
+        }
+        else
+        {
+            applyFuzz (channels, numChannels, numSamples, 1);
+        }
+
+        return true;
+    }
+
+    bool isInputSilent (const Sample* const* channels, int numChannels, int numSamples) const noexcept
+    {
+        // a ramp still in progress may be louder than where it's heading
+        auto threshold = getSilenceThreshold (_parameters.mode, _parameters.fuzz,
+                                              std::max (_parameters.gain, _gainSmoother.getCurrentValue()),
+                                              std::max (_parameters.volume, _volumeSmoother.getCurrentValue()),
+                                              std::min (_parameters.mix, _mixSmoother.getCurrentValue()));
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            if (_kernels->findPeak (channels[channel], numSamples) > (Sample) threshold)
+                return false;
+
+        return true;
+    }
+
+    void applyFuzz (Sample* const* channels, int numChannels, int numSamples, int oversamplingFactor) noexcept
+    {
+        const auto mode = _parameters.mode;
+        const auto fuzz = _parameters.fuzz;
+        auto processChannels = _kernels->getForChannels<Sample> (mode);
+
+        auto adaa = _antialiasing;
+        auto processWithAdaa = adaa ? _kernels->getAdaa<Sample> (mode) : nullptr;
+
+        if (adaa && ! _adaaActive)
+            std::fill (_adaaStates.begin(), _adaaStates.end(), AdaaState());
+
+        _adaaActive = adaa;
+
+        FuzzTableKernel processWithTable = nullptr;
+
+        if constexpr (std::is_same<Sample, float>::value)
+            if (! adaa && mode == FuzzMode::Black && _blackModeTable != nullptr)
+                processWithTable = _kernels->getBlackTable (_blackModeTable->getInterpolation());
+
+        // split wherever a ramp finishes so each segment is one straight
+        // line for all three
+        for (int start = 0; start < numSamples;)
+        {
+            auto length = _mixSmoother.getSegmentLength (_volumeSmoother.getSegmentLength (_gainSmoother.getSegmentLength (numSamples - start)));
+            auto gain = _gainSmoother.advance (length);
+            auto volume = _volumeSmoother.advance (length);
+            auto mix = _mixSmoother.advance (length);
+
+            // the smoothers run at the original rate, so stretch their
+            // ramps over the oversampled samples
+            gain.step /= (float) oversamplingFactor;
+            volume.step /= (float) oversamplingFactor;
+            mix.step /= (float) oversamplingFactor;
+
+            if (processWithAdaa == nullptr && processWithTable == nullptr)
+            {
+                processChannels (channels, numChannels, start * oversamplingFactor, length * oversamplingFactor, gain, volume, mix, fuzz);
+            }
+            else
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    auto* data = channels[channel] + start * oversamplingFactor;
+
+                    if (processWithAdaa != nullptr)
+                        processWithAdaa (data, length * oversamplingFactor, gain, volume, mix, fuzz, _adaaStates[(size_t) channel]);
+                    else if constexpr (std::is_same<Sample, float>::value)
+                        processWithTable (data, length * oversamplingFactor, gain, volume, mix, fuzz, *_blackModeTable);
+                }
+            }
+
+            start += length;
+        }
+    }
+
+    const FuzzKernelTable* _kernels;
+
+    FuzzParameters _parameters;
+    bool _antialiasing = false;
+    const WaveshaperTable* _blackModeTable = nullptr;
+
+    // gain, volume and mix ramp in the linear domain, everything else
+    // changes from one process() to the next
+    LinearSmoother _gainSmoother;
+    LinearSmoother _volumeSmoother;
+    LinearSmoother _mixSmoother;
+
+    Oversampler<Sample> _oversampler;
+
+    // each channel's last input for the ADAA kernels, zeroed whenever ADAA
+    // is switched on or the rate it runs at changes
+    std::vector<AdaaState> _adaaStates;
+    bool _adaaActive = false;
+
+    // how many samples of silent input have gone through since the last
+    // sound, so process() knows when nothing is left ringing
+    std::int64_t _silentSamples = 0;
+    bool _skipping = false;
+
+    // where each channel's next block starts
+    std::vector<Sample*> _block;
+
+    int _maxBlockSize = 0;
+    int _numChannels = 0;
+};
+
+} // namespace pandamonium
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    FuzzShapers.h
+    The three fuzz transfer functions, one sample at a time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+
+namespace pandamonium
+{
+
+/** Black mode: exponential soft clip. */
+inline float shapeBlack (float x, float fuzz) noexcept
+{
+    if (x < 0)
+        return -1.0f + std::exp (x * fuzz);
+
+    return 1.0f - std::exp (-x * fuzz);
+}
+
+/** White mode: piecewise quadratic with a flat top at 2/3 and unity above. */
+inline float shapeWhite (float x, float fuzz) noexcept
+{
+    const float threshold = 1.0f / 3.0f;
+    const float k = 6.0f * (fuzz / 30.0f);
+
+    if (x > threshold)
+    {
+        if (x > 2.0f * threshold)
+            x = 1.0f;
+        else
+            x = (3.0f - (2.0f - k*x) * (2.0f - k*x)) / 3.0f;
+    }
+    else if (x < -threshold)
+    {
+        if (x < -2.0f * threshold)
+            x = -1.0f;
+        else
+            x = -(3.0f - (2.0f - k*x) * (2.0f - k*x)) / 3.0f;
+    }
+    else
+    {
+        x *= 2.0f;
+    }
+
+    return x / 2.0f;
+}
+
+/** Red mode: hard clip to +/-1 above a fuzz-dependent threshold. */
+inline float shapeRed (float x, float fuzz) noexcept
+{
+    const float threshold = 1.0f - fuzz / 30.0f;
+
+    if (x > threshold)
+        return 1.0f;
+
+    if (x < -threshold)
+        return -1.0f;
+
+    return x;
+}
+
+} // namespace pandamonium
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    LatencyDelay.h
+    Delays the dry input by the processor's latency, a block at a time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace pandamonium
+{
+
+/**
+    A ring buffer per channel that hands back whole blocks of the input as
+    it was a fixed number of samples ago, so a dry signal can line up with
+    the processed one.
+
+    Every block goes through process(), which copies it in and, if the
+    delayed copy is needed, straight back out. Both are plain copies, so
+    keeping the delay fed costs next to nothing while nobody reads it.
+*/
+template <typename Sample>
+class LatencyDelay
+{
+public:
+    LatencyDelay() = default;
+
+    /** Allocates for blocks of up to maxBlockSize samples delayed by up to
+        maxDelay samples, and clears the history. Not realtime safe.
+    */
+    void prepare (int numChannels, int maxBlockSize, int maxDelay)
+    {
+        _maxBlockSize = std::max (1, maxBlockSize);
+        _size = _maxBlockSize + std::max (0, maxDelay);
+        _maxDelay = std::max (0, maxDelay);
+        _channels.assign ((std::size_t) numChannels, std::vector<Sample> ((std::size_t) _size, Sample (0)));
+        _writePosition = 0;
+        setDelay (_delay);
+    }
+
+    /** Changes the delay, up to the maxDelay given to prepare(). */
+    void setDelay (int numSamples) noexcept
+    {
+        _delay = std::min (std::max (0, numSamples), _maxDelay);
+    }
+
+    int getDelay() const noexcept   { return _delay; }
+
+    void reset() noexcept
+    {
+        for (auto& channel : _channels)
+            std::fill (channel.begin(), channel.end(), Sample (0));
+    }
+
+    /** Adds the next numSamples samples of input and, unless output is
+        nullptr, copies them out again as they were getDelay() samples
+        earlier. output may be the same buffers as input. Longer buffers
+        than prepare() allowed for are taken a block at a time, as the ring
+        only holds one block past the delay.
+    */
+    void process (const Sample* const* input, Sample* const* output, int numChannels, int numSamples) noexcept
+    {
+        numChannels = std::min (numChannels, (int) _channels.size());
+
+        for (int start = 0; start < numSamples; start += _maxBlockSize)
+        {
+            auto length = std::min (_maxBlockSize, numSamples - start);
+            auto readPosition = ((_writePosition - _delay) % _size + _size) % _size;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* ring = _channels[(std::size_t) channel].data();
+                copyIn (ring, input[channel] + start, _writePosition, length);
+
+                if (output != nullptr)
+                    copyOut (output[channel] + start, ring, readPosition, length);
+            }
+
+            _writePosition = (_writePosition + length) % _size;
+        }
+    }
+
+private:
+    void copyIn (Sample* ring, const Sample* source, int position, int numSamples) const noexcept
+    {
+        auto first = std::min (numSamples, _size - position);
+        std::copy (source, source + first, ring + position);
+        std::copy (source + first, source + numSamples, ring);
+    }
+
+    void copyOut (Sample* destination, const Sample* ring, int position, int numSamples) const noexcept
+    {
+        auto first = std::min (numSamples, _size - position);
+        std::copy (ring + position, ring + position + first, destination);
+        std::copy (ring, ring + (numSamples - first), destination + first);
+    }
+
+    std::vector<std::vector<Sample>> _channels;
+    int _size = 1;
+    int _maxBlockSize = 1;
+    int _maxDelay = 0;
+    int _delay = 0;
+    int _writePosition = 0;
+};
+
+} // namespace pandamonium
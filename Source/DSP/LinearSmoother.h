@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    LinearSmoother.h
+    Linear ramps for gain-style parameters, evaluated once per block.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+
+namespace pandamonium
+{
+
+//==============================================================================
+/** A ramp over a run of samples: value[i] = start + i * step. */
+struct Ramp
+{
+    float start = 0.0f;
+    float step = 0.0f;
+
+    bool isConstant() const noexcept { return step == 0.0f; }
+};
+
+//==============================================================================
+/**
+    Ramps a value linearly towards its target.
+
+    Unlike juce::SmoothedValue this never hands out per-sample values. The
+    audio thread asks for the longest run of samples the current ramp covers,
+    takes a Ramp for that run and lets the kernel compute the values itself,
+    so nothing about the parameter is touched inside the sample loop.
+*/
+class LinearSmoother
+{
+public:
+    LinearSmoother() = default;
+
+    /** Sets the ramp length. Call from prepareToPlay. */
+    void reset (double sampleRate, double rampLengthSeconds) noexcept
+    {
+        _rampLength = std::max (1, (int) (sampleRate * rampLengthSeconds));
+        setCurrentAndTarget (_target);
+    }
+
+    /** Jumps straight to a value, cancelling any ramp in progress. */
+    void setCurrentAndTarget (float value) noexcept
+    {
+        _current = _target = value;
+        _step = 0.0f;
+        _countdown = 0;
+    }
+
+    /** Starts a new ramp from the current value if the target has changed. */
+    void setTarget (float value) noexcept
+    {
+        if (value == _target)
+            return;
+
+        _target = value;
+        _countdown = _rampLength;
+        _step = (_target - _current) / (float) _rampLength;
+    }
+
+    bool isSmoothing() const noexcept       { return _countdown > 0; }
+    float getCurrentValue() const noexcept  { return _current; }
+    float getTargetValue() const noexcept   { return _target; }
+
+    /** Returns how many of the next maxSamples samples share one linear segment. */
+    int getSegmentLength (int maxSamples) const noexcept
+    {
+        return isSmoothing() ? std::min (maxSamples, _countdown) : maxSamples;
+    }
+
+    /** Returns the ramp for the next numSamples samples and moves past them.
+        numSamples must not be longer than getSegmentLength() allows.
+    */
+    Ramp advance (int numSamples) noexcept
+    {
+        if (! isSmoothing())
+            return { _current, 0.0f };
+
+        Ramp ramp { _current, _step };
+        _countdown -= numSamples;
+
+        if (_countdown <= 0)
+            setCurrentAndTarget (_target);
+        else
+            _current += _step * (float) numSamples;
+
+        return ramp;
+    }
+
+private:
+    float _current = 0.0f;
+    float _target = 0.0f;
+    float _step = 0.0f;
+    int _countdown = 0;
+    int _rampLength = 1;
+};
+
+} // namespace pandamonium
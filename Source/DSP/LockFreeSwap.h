@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    LockFreeSwap.h
+    Hands objects built on another thread to the audio thread without locks,
+    and without the audio thread ever freeing anything.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace pandamonium
+{
+
+/**
+    One slot each for the object waiting to be picked up, the one the audio
+    thread is using and the one it has finished with.
+
+    publish() and collect() may be called from any one non-audio thread;
+    acquire() only from the audio thread. The audio thread only swaps when
+    the retired slot is free, and publish() empties that slot after queueing,
+    so whatever was published last is picked up by the next acquire().
+*/
+template <typename ObjectType>
+class LockFreeSwap
+{
+public:
+    LockFreeSwap() = default;
+
+    ~LockFreeSwap()
+    {
+        delete _pending.load();
+        delete _retired.load();
+        delete _active;
+    }
+
+    /** Queues an object for the audio thread, replacing anything queued
+        that it hasn't picked up yet.
+    */
+    void publish (std::unique_ptr<ObjectType> object)
+    {
+        delete _pending.exchange (object.release(), std::memory_order_acq_rel);
+        collect();
+    }
+
+    /** Frees the object the audio thread last swapped out, if any. */
+    void collect()
+    {
+        delete _retired.exchange (nullptr, std::memory_order_acquire);
+    }
+
+    /** Audio thread: picks up anything published and returns the current
+        object (nullptr until the first publish), which stays valid until the
+        next call.
+    */
+    ObjectType* acquire() noexcept
+    {
+        if (_retired.load (std::memory_order_relaxed) == nullptr)
+        {
+            if (auto* next = _pending.exchange (nullptr, std::memory_order_acquire))
+            {
+                _retired.store (_active, std::memory_order_release);
+                _active = next;
+            }
+        }
+
+        return _active;
+    }
+
+private:
+    std::atomic<ObjectType*> _pending { nullptr };
+    std::atomic<ObjectType*> _retired { nullptr };
+    ObjectType* _active = nullptr;
+};
+
+} // namespace pandamonium
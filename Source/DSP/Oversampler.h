@@ -0,0 +1,681 @@
+/*
+  ==============================================================================
+
+    Oversampler.h
+    2x, 4x and 8x oversampling from cascaded half-band filters, in either
+    minimum phase (polyphase IIR) or linear phase (FIR).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace pandamonium
+{
+
+//==============================================================================
+enum class OversamplingFilter
+{
+    MinimumPhase = 0,   // polyphase allpass IIR, the least latency
+    LinearPhase         // equal-ripple FIR, no phase distortion
+};
+
+constexpr int numOversamplingFilters = 2;
+
+namespace detail
+{
+    constexpr double pi = 3.14159265358979323846;
+
+    /** The allpass coefficients of an elliptic half-band lowpass split into
+        two branches, after Valenzuela and Constantinides as laid out in
+        Laurent de Soras' HIIR. transitionWidth is the width of the band
+        around a quarter of the rate, as a fraction of the rate, and each
+        coefficient buys roughly another 12 dB of stopband.
+
+        Coefficients 0, 2, 4 ... belong to the first branch and 1, 3, 5 ...
+        to the second, which also has a sample of delay.
+    */
+    inline std::vector<double> designHalfBandAllpass (int numCoefficients, double transitionWidth)
+    {
+        auto k = std::tan ((1.0 - 2.0 * transitionWidth) * pi / 4.0);
+        k *= k;
+
+        const auto kk = std::pow (1.0 - k * k, 0.25);
+        const auto e = 0.5 * (1.0 - kk) / (1.0 + kk);
+        const auto e4 = std::pow (e, 4.0);
+        const auto q = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+        const auto order = 2 * numCoefficients + 1;
+
+        std::vector<double> coefficients;
+
+        for (int index = 1; index <= numCoefficients; ++index)
+        {
+            // the theta functions converge within a handful of terms for
+            // any transition width that's any use
+            double numerator = 0.0, denominator = 0.0;
+
+            for (int i = 0; i < 16; ++i)
+                numerator += (i % 2 == 0 ? 1.0 : -1.0) * std::pow (q, i * (i + 1)) * std::sin ((2 * i + 1) * index * pi / order);
+
+            for (int i = 1; i < 16; ++i)
+                denominator += (i % 2 == 0 ? 1.0 : -1.0) * std::pow (q, i * i) * std::cos (2 * i * index * pi / order);
+
+            const auto w = numerator * std::pow (q, 0.25) / (denominator + 0.5);
+            const auto w2 = w * w;
+            const auto x = std::sqrt ((1.0 - w2 * k) * (1.0 - w2 / k)) / (1.0 + w2);
+
+            coefficients.push_back ((1.0 - x) / (1.0 + x));
+        }
+
+        return coefficients;
+    }
+
+    /** The taps of a Kaiser-windowed half-band lowpass, 4 * halfLength - 1
+        of them, with a gain of 1. Every other tap but the middle one, 0.5,
+        is zero.
+    */
+    inline std::vector<double> designHalfBandFir (int halfLength, double attenuationDecibels)
+    {
+        auto besselI0 = [] (double x)
+        {
+            double sum = 1.0, term = 1.0;
+
+            for (int k = 1; k < 64 && term > 1.0e-12 * sum; ++k)
+            {
+                term *= (x / (2 * k)) * (x / (2 * k));
+                sum += term;
+            }
+
+            return sum;
+        };
+
+        const auto beta = 0.1102 * (attenuationDecibels - 8.7);
+        const auto centre = 2 * halfLength - 1;
+        std::vector<double> taps ((size_t) (4 * halfLength - 1));
+
+        for (int m = 0; m < (int) taps.size(); ++m)
+        {
+            const auto n = m - centre;
+            const auto r = (double) n / centre;
+            const auto sinc = n == 0 ? 0.5 : std::sin (pi * n / 2.0) / (pi * n);
+
+            taps[(size_t) m] = sinc * besselI0 (beta * std::sqrt (1.0 - r * r)) / besselI0 (beta);
+        }
+
+        return taps;
+    }
+
+    /** The last length values pushed, readable newest first from one
+        pointer without wrapping, by writing each value twice.
+    */
+    template <typename Sample>
+    class History
+    {
+    public:
+        void prepare (int length)
+        {
+            _length = std::max (1, length);
+            _values.assign ((size_t) (2 * _length), Sample (0));
+            _position = 0;
+        }
+
+        void reset() noexcept
+        {
+            std::fill (_values.begin(), _values.end(), Sample (0));
+        }
+
+        void push (Sample value) noexcept
+        {
+            _position = (_position == 0 ? _length : _position) - 1;
+            _values[(size_t) _position] = _values[(size_t) (_position + _length)] = value;
+        }
+
+        /** [0] is the newest value, [length - 1] the oldest. */
+        const Sample* get() const noexcept      { return _values.data() + _position; }
+
+    private:
+        std::vector<Sample> _values;
+        int _length = 1;
+        int _position = 0;
+    };
+}
+
+//==============================================================================
+/**
+    One 2x stage of minimum phase oversampling: H(z) = (A0(z^2) + z^-1 A1(z^2)) / 2
+    with A0 and A1 chains of first-order allpasses, run polyphase so each
+    allpass only ever sees the lower rate.
+*/
+template <typename Sample>
+class HalfBandAllpassStage
+{
+public:
+    /** Allocates for numChannels channels and clears them. */
+    void prepare (const std::vector<double>& coefficients, int numChannels)
+    {
+        _coefficients.assign (coefficients.begin(), coefficients.end());
+
+        // per channel, (x[n-1], y[n-1]) for every allpass going up, the same
+        // going down, and the odd sample the way down holds back
+        _stride = 4 * (int) _coefficients.size() + 1;
+        _state.assign ((size_t) (_stride * numChannels), Sample (0));
+    }
+
+    void reset() noexcept
+    {
+        std::fill (_state.begin(), _state.end(), Sample (0));
+    }
+
+    /** The delay of the way up and back down at low frequencies, in
+        samples at the lower rate. Each allpass (a + z^-1) / (1 + a z^-1)
+        delays DC by (1 - a) / (1 + a), twice that in z^-2, and the two
+        branches, in phase at DC, average out.
+    */
+    double getDelay() const noexcept
+    {
+        double branches[2] = { 0.0, 1.0 };
+
+        for (size_t i = 0; i < _coefficients.size(); ++i)
+            branches[i % 2] += 2.0 * (1.0 - (double) _coefficients[i]) / (1.0 + (double) _coefficients[i]);
+
+        return (branches[0] + branches[1]) / 2.0;
+    }
+
+    /** Writes 2 * numSamples samples to output. */
+    void upsample (int channel, const Sample* input, Sample* output, int numSamples) noexcept
+    {
+        auto* state = _state.data() + _stride * channel;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            output[2 * i] = runBranch (input[i], 0, state);
+            output[2 * i + 1] = runBranch (input[i], 1, state);
+        }
+    }
+
+    /** Reads 2 * numSamples samples from input. */
+    void downsample (int channel, const Sample* input, Sample* output, int numSamples) noexcept
+    {
+        auto* state = _state.data() + _stride * channel;
+        auto* downState = state + 2 * _coefficients.size();
+        auto& lastOdd = state[_stride - 1];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto even = runBranch (input[2 * i], 0, downState);
+            auto odd = runBranch (lastOdd, 1, downState);
+
+            lastOdd = input[2 * i + 1];
+            output[i] = (even + odd) * Sample (0.5);
+        }
+    }
+
+private:
+    Sample runBranch (Sample x, int branch, Sample* state) const noexcept
+    {
+        for (size_t i = (size_t) branch; i < _coefficients.size(); i += 2)
+        {
+            auto& x1 = state[2 * i];
+            auto& y1 = state[2 * i + 1];
+            auto y = _coefficients[i] * (x - y1) + x1;
+
+            x1 = x;
+            y1 = y;
+            x = y;
+        }
+
+        return x;
+    }
+
+    std::vector<Sample> _coefficients;
+    std::vector<Sample> _state;
+    int _stride = 1;
+};
+
+//==============================================================================
+/**
+    One 2x stage of linear phase oversampling. Half the taps of a half-band
+    filter are zero, so going up every odd output is a delayed copy of the
+    input and going down every odd input only meets the middle tap.
+*/
+template <typename Sample>
+class HalfBandFirStage
+{
+public:
+    /** Allocates for numChannels channels and clears them. taps must come
+        from detail::designHalfBandFir().
+    */
+    void prepare (const std::vector<double>& taps, int numChannels)
+    {
+        _halfLength = ((int) taps.size() + 1) / 4;
+        _evenTaps.clear();
+
+        for (size_t m = 0; m < taps.size(); m += 2)
+            _evenTaps.push_back ((Sample) taps[m]);
+
+        const auto numEvenTaps = (int) _evenTaps.size();
+
+        _up.assign ((size_t) numChannels, {});
+        _downEven.assign ((size_t) numChannels, {});
+        _downOdd.assign ((size_t) numChannels, {});
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            _up[(size_t) channel].prepare (numEvenTaps);
+            _downEven[(size_t) channel].prepare (numEvenTaps);
+            _downOdd[(size_t) channel].prepare (_halfLength);
+        }
+    }
+
+    void reset() noexcept
+    {
+        for (auto* histories : { &_up, &_downEven, &_downOdd })
+            for (auto& history : *histories)
+                history.reset();
+    }
+
+    /** The delay of the way up and back down, in samples at the lower
+        rate: the middle tap's position, once each way at the higher rate.
+    */
+    int getDelay() const noexcept       { return 2 * _halfLength - 1; }
+
+    void upsample (int channel, const Sample* input, Sample* output, int numSamples) noexcept
+    {
+        auto& history = _up[(size_t) channel];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            history.push (input[i]);
+
+            output[2 * i] = Sample (2) * dot (history.get());
+            output[2 * i + 1] = history.get()[_halfLength - 1];
+        }
+    }
+
+    void downsample (int channel, const Sample* input, Sample* output, int numSamples) noexcept
+    {
+        auto& even = _downEven[(size_t) channel];
+        auto& odd = _downOdd[(size_t) channel];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            even.push (input[2 * i]);
+            output[i] = dot (even.get()) + Sample (0.5) * odd.get()[_halfLength - 1];
+            odd.push (input[2 * i + 1]);
+        }
+    }
+
+private:
+    Sample dot (const Sample* newestFirst) const noexcept
+    {
+        Sample sum = 0;
+
+        for (size_t j = 0; j < _evenTaps.size(); ++j)
+            sum += _evenTaps[j] * newestFirst[j];
+
+        return sum;
+    }
+
+    std::vector<Sample> _evenTaps;
+    std::vector<detail::History<Sample>> _up, _downEven, _downOdd;
+    int _halfLength = 1;
+};
+
+//==============================================================================
+/**
+    Up to three 2x stages, for 2x, 4x or 8x, with a whole number of samples
+    of latency so a host (or a dry signal) can line up with it exactly.
+
+    The first stage does the real work, flat to 90% of the original Nyquist
+    frequency and at least 90 dB down from a little above it. The later
+    stages only have to keep what they fold back out of the original band,
+    so they're much shorter. Minimum phase is rounded up to whole samples
+    with a first-order Thiran allpass after the last stage down, which only
+    delays; linear phase is rounded up with a few samples of plain delay at
+    the top rate, so it stays linear phase.
+
+    Every combination is allocated in prepare(), so setup() can switch
+    between them on the audio thread.
+*/
+template <typename Sample>
+class Oversampler
+{
+public:
+    static constexpr int maxStages = 3;
+
+    Oversampler() = default;
+
+    /** Designs every stage and allocates for numChannels channels of up to
+        maxBlockSize samples. Not realtime safe.
+    */
+    void prepare (int numChannels, int maxBlockSize)
+    {
+        _numChannels = std::max (1, numChannels);
+        _maxBlockSize = std::max (1, maxBlockSize);
+
+        const auto firstAllpass = detail::designHalfBandAllpass (8, 0.04);
+        const auto laterAllpass = detail::designHalfBandAllpass (4, 0.25);
+        const auto firstFir = detail::designHalfBandFir (30, 90.0);
+        const auto laterFir = detail::designHalfBandFir (7, 90.0);
+
+        for (int stage = 0; stage < maxStages; ++stage)
+        {
+            auto& s = _stages[stage];
+            s.allpass.prepare (stage == 0 ? firstAllpass : laterAllpass, _numChannels);
+            s.fir.prepare (stage == 0 ? firstFir : laterFir, _numChannels);
+            s.buffers.assign ((size_t) _numChannels, std::vector<Sample> ((size_t) (_maxBlockSize << (stage + 1))));
+            s.pointers.resize ((size_t) _numChannels);
+
+            for (int channel = 0; channel < _numChannels; ++channel)
+                s.pointers[(size_t) channel] = s.buffers[(size_t) channel].data();
+        }
+
+        planLatencies();
+
+        _thiranState.assign ((size_t) (2 * _numChannels), Sample (0));
+        _padding.assign ((size_t) (_numChannels << maxStages), Sample (0));
+        _prepared = true;
+
+        measureTails();
+    }
+
+    /** Frees everything prepare() allocated. */
+    void release()
+    {
+        *this = Oversampler();
+    }
+
+    /** Picks how many stages to run, 0 being none, and which filters. The
+        filters start from silence whenever this changes anything.
+    */
+    void setup (int numStages, OversamplingFilter filter) noexcept
+    {
+        numStages = std::min (std::max (0, numStages), maxStages);
+
+        if (numStages == _numStages && filter == _filter)
+            return;
+
+        _numStages = numStages;
+        _filter = filter;
+        reset();
+    }
+
+    int getNumStages() const noexcept               { return _numStages; }
+    int getFactor() const noexcept                  { return 1 << _numStages; }
+    OversamplingFilter getFilter() const noexcept   { return _filter; }
+
+    /** The delay the current setup adds, or 0 before prepare(). */
+    int getLatencySamples() const noexcept
+    {
+        return _numStages == 0 || ! _prepared ? 0 : _plans[(int) _filter][_numStages].latency;
+    }
+
+    /** The most delay any setup adds. */
+    int getMaxLatencySamples() const noexcept
+    {
+        int latency = 0;
+
+        for (auto& plans : _plans)
+            for (auto& plan : plans)
+                latency = std::max (latency, plan.latency);
+
+        return _prepared ? latency : 0;
+    }
+
+    /** How long the current setup keeps ringing after its input stops, or
+        0 before prepare(). This is the time the filters take to decay below
+        ringLevel on the way up plus on the way down, which for minimum
+        phase is far longer than the latency.
+    */
+    int getTailSamples() const noexcept
+    {
+        return _numStages == 0 || ! _prepared ? 0 : _plans[(int) _filter][_numStages].tail;
+    }
+
+    /** The level, relative to what went in, that the tails are measured
+        down to. Anything in between the two halves can amplify what's left
+        of the upsampling ring by a lot (Black at full gain, fuzz and volume
+        by about 2^13), so this leaves room for that and still ends under
+        the last bit of a 24-bit render.
+    */
+    static constexpr double ringLevel = 1.0 / 1099511627776.0;     // 2^-40
+
+    void reset() noexcept
+    {
+        for (auto& stage : _stages)
+        {
+            stage.allpass.reset();
+            stage.fir.reset();
+        }
+
+        std::fill (_thiranState.begin(), _thiranState.end(), Sample (0));
+        std::fill (_padding.begin(), _padding.end(), Sample (0));
+        _paddingPosition = 0;
+    }
+
+    /** Runs numSamples samples of numChannels channels up through every
+        stage and returns the channels at the top rate, getFactor() times
+        as long. Process them in place, then hand back to downsample().
+    */
+    Sample* const* upsample (const Sample* const* channels, int numChannels, int numSamples) noexcept
+    {
+        for (int stage = 0; stage < _numStages; ++stage)
+        {
+            auto& s = _stages[stage];
+            const auto length = numSamples << stage;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* input = stage == 0 ? channels[channel] : _stages[stage - 1].pointers[(size_t) channel];
+
+                if (_filter == OversamplingFilter::MinimumPhase)
+                    s.allpass.upsample (channel, input, s.pointers[(size_t) channel], length);
+                else
+                    s.fir.upsample (channel, input, s.pointers[(size_t) channel], length);
+            }
+        }
+
+        return _stages[_numStages - 1].pointers.data();
+    }
+
+    /** Takes what upsample() returned back down to the original rate, into
+        channels.
+    */
+    void downsample (Sample* const* channels, int numChannels, int numSamples) noexcept
+    {
+        auto& plan = _plans[(int) _filter][_numStages];
+
+        if (plan.padding > 0)
+            pad (numChannels, numSamples << _numStages, plan.padding);
+
+        for (int stage = _numStages; --stage >= 0;)
+        {
+            auto& s = _stages[stage];
+            const auto length = numSamples << stage;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* output = stage == 0 ? channels[channel] : _stages[stage - 1].pointers[(size_t) channel];
+
+                if (_filter == OversamplingFilter::MinimumPhase)
+                    s.allpass.downsample (channel, s.pointers[(size_t) channel], output, length);
+                else
+                    s.fir.downsample (channel, s.pointers[(size_t) channel], output, length);
+            }
+        }
+
+        if (_filter == OversamplingFilter::MinimumPhase)
+            delayByFraction (channels, numChannels, numSamples, (Sample) plan.thiranCoefficient);
+    }
+
+private:
+    struct Stage
+    {
+        HalfBandAllpassStage<Sample> allpass;
+        HalfBandFirStage<Sample> fir;
+        std::vector<std::vector<Sample>> buffers;
+        std::vector<Sample*> pointers;
+    };
+
+    // how each filter and number of stages gets to a whole number of samples
+    struct Plan
+    {
+        int latency = 0;
+        int padding = 0;                    // samples at the top rate
+        double thiranCoefficient = 0.0;
+        int tail = 0;
+    };
+
+    void planLatencies() noexcept
+    {
+        for (int stages = 1; stages <= maxStages; ++stages)
+        {
+            // each stage's delay counts for less the higher up it runs
+            double fractional = 0.0;
+            int topRate = 0;
+
+            for (int stage = 0; stage < stages; ++stage)
+            {
+                fractional += _stages[stage].allpass.getDelay() / (double) (1 << stage);
+                topRate += _stages[stage].fir.getDelay() << (stages - stage);
+            }
+
+            // a first-order Thiran allpass is best between 0.5 and 1.5 samples
+            auto& minimumPhase = _plans[(int) OversamplingFilter::MinimumPhase][stages];
+            minimumPhase.latency = (int) std::ceil (fractional + 0.5);
+
+            const auto fraction = minimumPhase.latency - fractional;
+            minimumPhase.thiranCoefficient = (1.0 - fraction) / (1.0 + fraction);
+
+            auto& linearPhase = _plans[(int) OversamplingFilter::LinearPhase][stages];
+            const auto factor = 1 << stages;
+            linearPhase.padding = (factor - topRate % factor) % factor;
+            linearPhase.latency = (topRate + linearPhase.padding) / factor;
+        }
+    }
+
+    /** Runs an impulse through each setup, up and then down separately,
+        and notes how long each takes to stay below ringLevel. Leaves the
+        setup as it was, reset.
+    */
+    void measureTails()
+    {
+        const auto numStages = _numStages;
+        const auto filter = _filter;
+        const int maxTail = 1 << 14;
+
+        std::vector<Sample> input ((size_t) _maxBlockSize);
+        Sample* channel[] = { input.data() };
+
+        auto ringsUntil = [&] (bool up)
+        {
+            reset();
+            int last = 0;
+
+            for (int start = 0; start < maxTail; start += _maxBlockSize)
+            {
+                const auto length = std::min (_maxBlockSize, maxTail - start);
+                std::fill (input.begin(), input.end(), Sample (0));
+
+                if (up)
+                    input[0] = Sample (start == 0);
+
+                auto* top = upsample (channel, 1, length)[0];
+
+                if (up)
+                {
+                    for (int i = 0; i < (length << _numStages); ++i)
+                        if (std::abs (top[i]) > ringLevel)
+                            last = start + (i >> _numStages) + 1;
+                }
+                else
+                {
+                    std::fill (top, top + (length << _numStages), Sample (0));
+                    top[0] = Sample (start == 0);
+
+                    downsample (channel, 1, length);
+
+                    for (int i = 0; i < length; ++i)
+                        if (std::abs (input[(size_t) i]) > ringLevel)
+                            last = start + i + 1;
+                }
+            }
+
+            return last;
+        };
+
+        for (int f = 0; f < numOversamplingFilters; ++f)
+        {
+            for (int stages = 1; stages <= maxStages; ++stages)
+            {
+                _numStages = stages;
+                _filter = (OversamplingFilter) f;
+                _plans[f][stages].tail = ringsUntil (true) + ringsUntil (false);
+            }
+        }
+
+        _numStages = numStages;
+        _filter = filter;
+        reset();
+    }
+
+    void pad (int numChannels, int numSamples, int padding) noexcept
+    {
+        const auto size = 1 << maxStages;
+        auto position = _paddingPosition;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* ring = _padding.data() + size * channel;
+            auto* data = _stages[_numStages - 1].pointers[(size_t) channel];
+            position = _paddingPosition;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                std::swap (data[i], ring[position]);
+                position = position + 1 == padding ? 0 : position + 1;
+            }
+        }
+
+        _paddingPosition = position;
+    }
+
+    void delayByFraction (Sample* const* channels, int numChannels, int numSamples, Sample a) noexcept
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = channels[channel];
+            auto& x1 = _thiranState[(size_t) (2 * channel)];
+            auto& y1 = _thiranState[(size_t) (2 * channel + 1)];
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto x = data[i];
+                auto y = a * (x - y1) + x1;
+
+                x1 = x;
+                y1 = y;
+                data[i] = y;
+            }
+        }
+    }
+
+    Stage _stages[maxStages];
+    Plan _plans[numOversamplingFilters][maxStages + 1];
+
+    std::vector<Sample> _thiranState;
+    std::vector<Sample> _padding;
+    int _paddingPosition = 0;
+
+    int _numChannels = 0;
+    int _maxBlockSize = 0;
+    int _numStages = 0;
+    OversamplingFilter _filter = OversamplingFilter::MinimumPhase;
+    bool _prepared = false;
+};
+
+} // namespace pandamonium
@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    ParameterEvents.h
+    Timestamped parameter changes, and the values they leave in effect.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace pandamonium
+{
+
+//==============================================================================
+/** The parameters that can change partway through a block. */
+enum class AutomatedParameter
+{
+    Gain = 0,
+    Fuzz,
+    Volume,
+    Mode,
+    Mix
+};
+
+constexpr int numAutomatedParameters = 5;
+
+/** One change, in the parameter's own units (decibels for gain and volume,
+    percent for mix), sampleOffset samples into the block it was added for.
+*/
+struct ParameterEvent
+{
+    int sampleOffset;
+    AutomatedParameter parameter;
+    float value;
+};
+
+//==============================================================================
+/** One block's events in time order, with events at the same sample kept in
+    the order they were added. The space is allocated up front, so adding
+    never allocates and is safe on the audio thread.
+*/
+class ParameterEventQueue
+{
+public:
+    explicit ParameterEventQueue (int capacity)
+        : _events ((std::size_t) capacity)
+    {
+    }
+
+    /** Returns false, and drops the event, if the queue is full. */
+    bool add (ParameterEvent event) noexcept
+    {
+        if (_size == (int) _events.size())
+            return false;
+
+        auto i = _size++;
+
+        for (; i > 0 && _events[(std::size_t) i - 1].sampleOffset > event.sampleOffset; --i)
+            _events[(std::size_t) i] = _events[(std::size_t) i - 1];
+
+        _events[(std::size_t) i] = event;
+        return true;
+    }
+
+    void clear() noexcept                                       { _size = 0; }
+
+    int size() const noexcept                                   { return _size; }
+    const ParameterEvent& operator[] (int index) const noexcept { return _events[(std::size_t) index]; }
+
+private:
+    std::vector<ParameterEvent> _events;
+    int _size = 0;
+};
+
+//==============================================================================
+/** The value each parameter was last set to by an event, layered over the
+    host's own value. An event's value holds across blocks until the host's
+    value moves away from where it was when the event landed, so a knob
+    turned afterwards still wins.
+*/
+class AutomatedValues
+{
+public:
+    float get (AutomatedParameter parameter, float hostValue) const noexcept
+    {
+        auto& slot = _slots[(int) parameter];
+        return slot.active ? slot.value : hostValue;
+    }
+
+    void set (AutomatedParameter parameter, float value, float hostValue) noexcept
+    {
+        _slots[(int) parameter] = { true, value, hostValue };
+    }
+
+    /** Forgets any event value whose host value has since changed. */
+    void dropOverridden (AutomatedParameter parameter, float hostValue) noexcept
+    {
+        auto& slot = _slots[(int) parameter];
+
+        if (slot.active && slot.hostValue != hostValue)
+            slot.active = false;
+    }
+
+    void reset() noexcept
+    {
+        for (auto& slot : _slots)
+            slot.active = false;
+    }
+
+private:
+    struct Slot
+    {
+        bool active = false;
+        float value = 0.0f;
+        float hostValue = 0.0f;     // the host's value when the event landed
+    };
+
+    Slot _slots[numAutomatedParameters];
+};
+
+} // namespace pandamonium
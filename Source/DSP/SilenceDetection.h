@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    SilenceDetection.h
+    How quiet an input block must be for the output to be silent.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+
+#include "FuzzParameters.h"
+
+namespace pandamonium
+{
+
+/** Output below this is treated as silence: 2^-24, under the last bit of a
+    24-bit render.
+*/
+constexpr float silenceLevel = 1.0f / 16777216.0f;
+
+/** The largest input peak whose output is certain to stay below
+    silenceLevel at these settings, or 0 if only true digital silence is.
+
+    Every mode maps 0 to 0 and rises no faster than its slope at the origin
+    until it reaches a step or a knee: Black rises at fuzz, White and Red at
+    1 up to 1/3 and the clipping threshold respectively. Red at full fuzz
+    has its step at 0 itself, so any input at all comes out at full scale.
+
+    Below a mix of 1 the output is a blend of that and the input itself, so
+    the input has to be below silenceLevel as well.
+*/
+inline float getSilenceThreshold (FuzzMode mode, float fuzz, float gain, float volume, float mix = 1.0f) noexcept
+{
+    if (gain <= 0.0f || volume <= 0.0f)
+        return 0.0f;
+
+    // the most a silent output may be before volume, as an input after gain
+    const auto shaped = silenceLevel / volume;
+    float input = 0.0f;
+
+    switch (mode)
+    {
+        case FuzzMode::Black:   input = shaped / std::max (1.0f, fuzz); break;
+        case FuzzMode::White:   input = std::min (shaped, 1.0f / 3.0f); break;
+        case FuzzMode::Red:     input = std::min (shaped, 1.0f - fuzz / 30.0f); break;
+    }
+
+    auto threshold = std::max (0.0f, input) / gain;
+    return mix < 1.0f ? std::min (threshold, silenceLevel) : threshold;
+}
+
+} // namespace pandamonium
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    SimdTarget.h
+    Which instruction sets the kernels are built for, and how to switch the
+    compiler into each of them for a region of code.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#if defined (__x86_64__) || defined (_M_X64) || defined (__i386__) || defined (_M_IX86)
+ #define PANDAMONIUM_X86 1
+ #include <immintrin.h>
+#else
+ #define PANDAMONIUM_X86 0
+#endif
+
+#if defined (__aarch64__) || defined (_M_ARM64)
+ #define PANDAMONIUM_NEON 1
+ #include <arm_neon.h>
+#else
+ #define PANDAMONIUM_NEON 0
+#endif
+
+//==============================================================================
+/*  Each instruction set gets its own namespace, and every function in it is
+    compiled for that instruction set only. GCC and Clang need the region
+    marked so that the intrinsics can be inlined; MSVC accepts any intrinsic
+    anywhere, so the markers are empty there.
+
+    Nothing outside these regions is compiled for anything but the baseline,
+    so the only code that can ever run on an older CPU is the code it was
+    dispatched to.
+*/
+#if defined (__clang__)
+ #define PANDAMONIUM_TARGET_BEGIN_SSE2   _Pragma ("clang attribute push (__attribute__((target(\"sse2\"))), apply_to = function)")
+ #define PANDAMONIUM_TARGET_BEGIN_AVX2   _Pragma ("clang attribute push (__attribute__((target(\"avx2,fma\"))), apply_to = function)")
+ #define PANDAMONIUM_TARGET_BEGIN_AVX512 _Pragma ("clang attribute push (__attribute__((target(\"avx512f,avx2,fma\"))), apply_to = function)")
+ #define PANDAMONIUM_TARGET_END          _Pragma ("clang attribute pop")
+#elif defined (__GNUC__)
+ #define PANDAMONIUM_TARGET_BEGIN_SSE2   _Pragma ("GCC push_options") _Pragma ("GCC target (\"sse2\")")
+ #define PANDAMONIUM_TARGET_BEGIN_AVX2   _Pragma ("GCC push_options") _Pragma ("GCC target (\"avx2,fma\")")
+ #define PANDAMONIUM_TARGET_BEGIN_AVX512 _Pragma ("GCC push_options") _Pragma ("GCC target (\"avx512f,avx2,fma\")")
+ #define PANDAMONIUM_TARGET_END          _Pragma ("GCC pop_options")
+#else
+ #define PANDAMONIUM_TARGET_BEGIN_SSE2
+ #define PANDAMONIUM_TARGET_BEGIN_AVX2
+ #define PANDAMONIUM_TARGET_BEGIN_AVX512
+ #define PANDAMONIUM_TARGET_END
+#endif
+
+// NEON is part of the AArch64 baseline, so it never needs a region.
@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    VecAVX2.h
+    Eight float or four double lanes in an AVX2 register.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SimdTarget.h"
+
+#if PANDAMONIUM_X86
+
+PANDAMONIUM_TARGET_BEGIN_AVX2
+
+namespace pandamonium
+{
+namespace avx2
+{
+
+struct Vec
+{
+    using Sample = float;
+    using Type = __m256;
+    using Mask = __m256;
+    using Int = __m256i;
+
+    static constexpr int size = 8;
+    static constexpr int alignment = 32;
+
+    static Type broadcast (float v) noexcept                { return _mm256_set1_ps (v); }
+    static Type lanes() noexcept                            { return _mm256_setr_ps (0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+    static Type load (const float* p) noexcept              { return _mm256_loadu_ps (p); }
+    static Type loadAligned (const float* p) noexcept       { return _mm256_load_ps (p); }
+    static void store (float* p, Type v) noexcept           { _mm256_storeu_ps (p, v); }
+    static void storeAligned (float* p, Type v) noexcept    { _mm256_store_ps (p, v); }
+
+    static Type add (Type a, Type b) noexcept               { return _mm256_add_ps (a, b); }
+    static Type sub (Type a, Type b) noexcept               { return _mm256_sub_ps (a, b); }
+    static Type mul (Type a, Type b) noexcept               { return _mm256_mul_ps (a, b); }
+    static Type div (Type a, Type b) noexcept               { return _mm256_div_ps (a, b); }
+    static Type max (Type a, Type b) noexcept               { return _mm256_max_ps (a, b); }
+    static Type min (Type a, Type b) noexcept               { return _mm256_min_ps (a, b); }
+    static Type abs (Type a) noexcept                       { return _mm256_andnot_ps (signMask(), a); }
+
+    static Type copySign (Type mag, Type sgn) noexcept
+    {
+        return _mm256_or_ps (_mm256_andnot_ps (signMask(), mag), _mm256_and_ps (signMask(), sgn));
+    }
+
+    static Mask greaterThan (Type a, Type b) noexcept       { return _mm256_cmp_ps (a, b, _CMP_GT_OQ); }
+    static Mask lessThan (Type a, Type b) noexcept          { return _mm256_cmp_ps (a, b, _CMP_LT_OQ); }
+
+    static Type select (Mask m, Type a, Type b) noexcept    { return _mm256_blendv_ps (b, a, m); }
+
+    static Type roundNearest (Type a) noexcept              { return _mm256_cvtepi32_ps (_mm256_cvtps_epi32 (a)); }
+
+    static Type pow2 (Type n) noexcept
+    {
+        return _mm256_castsi256_ps (_mm256_slli_epi32 (_mm256_add_epi32 (_mm256_cvtps_epi32 (n), _mm256_set1_epi32 (127)), 23));
+    }
+
+    static Int truncate (Type a) noexcept                   { return _mm256_cvttps_epi32 (a); }
+    static Type toFloat (Int i) noexcept                    { return _mm256_cvtepi32_ps (i); }
+    static Type gather (const float* table, Int i) noexcept { return _mm256_i32gather_ps (table, i, 4); }
+
+private:
+    static Type signMask() noexcept                         { return _mm256_set1_ps (-0.0f); }
+};
+
+//==============================================================================
+struct VecDouble
+{
+    using Sample = double;
+    using Type = __m256d;
+    using Mask = __m256d;
+
+    static constexpr int size = 4;
+    static constexpr int alignment = 32;
+
+    static Type broadcast (double v) noexcept               { return _mm256_set1_pd (v); }
+    static Type lanes() noexcept                            { return _mm256_setr_pd (0.0, 1.0, 2.0, 3.0); }
+    static Type load (const double* p) noexcept             { return _mm256_loadu_pd (p); }
+    static Type loadAligned (const double* p) noexcept      { return _mm256_load_pd (p); }
+    static void store (double* p, Type v) noexcept          { _mm256_storeu_pd (p, v); }
+    static void storeAligned (double* p, Type v) noexcept   { _mm256_store_pd (p, v); }
+
+    static Type add (Type a, Type b) noexcept               { return _mm256_add_pd (a, b); }
+    static Type sub (Type a, Type b) noexcept               { return _mm256_sub_pd (a, b); }
+    static Type mul (Type a, Type b) noexcept               { return _mm256_mul_pd (a, b); }
+    static Type div (Type a, Type b) noexcept               { return _mm256_div_pd (a, b); }
+    static Type max (Type a, Type b) noexcept               { return _mm256_max_pd (a, b); }
+    static Type min (Type a, Type b) noexcept               { return _mm256_min_pd (a, b); }
+    static Type abs (Type a) noexcept                       { return _mm256_andnot_pd (signMask(), a); }
+
+    static Type copySign (Type mag, Type sgn) noexcept
+    {
+        return _mm256_or_pd (_mm256_andnot_pd (signMask(), mag), _mm256_and_pd (signMask(), sgn));
+    }
+
+    static Mask greaterThan (Type a, Type b) noexcept       { return _mm256_cmp_pd (a, b, _CMP_GT_OQ); }
+    static Mask lessThan (Type a, Type b) noexcept          { return _mm256_cmp_pd (a, b, _CMP_LT_OQ); }
+
+    static Type select (Mask m, Type a, Type b) noexcept    { return _mm256_blendv_pd (b, a, m); }
+
+    static Type roundNearest (Type a) noexcept              { return _mm256_round_pd (a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+    static Type pow2 (Type n) noexcept
+    {
+        auto biased = _mm_add_epi32 (_mm256_cvtpd_epi32 (n), _mm_set1_epi32 (1023));
+        return _mm256_castsi256_pd (_mm256_slli_epi64 (_mm256_cvtepi32_epi64 (biased), 52));
+    }
+
+private:
+    static Type signMask() noexcept                         { return _mm256_set1_pd (-0.0); }
+};
+
+} // namespace avx2
+} // namespace pandamonium
+
+PANDAMONIUM_TARGET_END
+
+#endif
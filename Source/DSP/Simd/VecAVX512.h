@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    VecAVX512.h
+    Sixteen float or eight double lanes in an AVX-512 register.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SimdTarget.h"
+
+#if PANDAMONIUM_X86
+
+PANDAMONIUM_TARGET_BEGIN_AVX512
+
+namespace pandamonium
+{
+namespace avx512
+{
+
+struct Vec
+{
+    using Sample = float;
+    using Type = __m512;
+    using Mask = __mmask16;
+    using Int = __m512i;
+
+    static constexpr int size = 16;
+    static constexpr int alignment = 64;
+
+    static Type broadcast (float v) noexcept                { return _mm512_set1_ps (v); }
+    static Type lanes() noexcept                            { return _mm512_setr_ps (0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+                                                                                     8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f); }
+    static Type load (const float* p) noexcept              { return _mm512_loadu_ps (p); }
+    static Type loadAligned (const float* p) noexcept       { return _mm512_load_ps (p); }
+    static void store (float* p, Type v) noexcept           { _mm512_storeu_ps (p, v); }
+    static void storeAligned (float* p, Type v) noexcept    { _mm512_store_ps (p, v); }
+
+    static Type add (Type a, Type b) noexcept               { return _mm512_add_ps (a, b); }
+    static Type sub (Type a, Type b) noexcept               { return _mm512_sub_ps (a, b); }
+    static Type mul (Type a, Type b) noexcept               { return _mm512_mul_ps (a, b); }
+    static Type div (Type a, Type b) noexcept               { return _mm512_div_ps (a, b); }
+    static Type max (Type a, Type b) noexcept               { return _mm512_max_ps (a, b); }
+    static Type min (Type a, Type b) noexcept               { return _mm512_min_ps (a, b); }
+    static Type abs (Type a) noexcept                       { return _mm512_abs_ps (a); }
+
+    // the float bitwise ops need AVX512DQ, so go through the integer ones
+    static Type copySign (Type mag, Type sgn) noexcept
+    {
+        auto signBit = _mm512_set1_epi32 ((int) 0x80000000u);
+        return _mm512_castsi512_ps (_mm512_or_si512 (_mm512_andnot_si512 (signBit, _mm512_castps_si512 (mag)),
+                                                     _mm512_and_si512 (signBit, _mm512_castps_si512 (sgn))));
+    }
+
+    static Mask greaterThan (Type a, Type b) noexcept       { return _mm512_cmp_ps_mask (a, b, _CMP_GT_OQ); }
+    static Mask lessThan (Type a, Type b) noexcept          { return _mm512_cmp_ps_mask (a, b, _CMP_LT_OQ); }
+    static Type select (Mask m, Type a, Type b) noexcept    { return _mm512_mask_blend_ps (m, b, a); }
+
+    static Type roundNearest (Type a) noexcept              { return _mm512_cvtepi32_ps (_mm512_cvtps_epi32 (a)); }
+
+    static Type pow2 (Type n) noexcept
+    {
+        return _mm512_castsi512_ps (_mm512_slli_epi32 (_mm512_add_epi32 (_mm512_cvtps_epi32 (n), _mm512_set1_epi32 (127)), 23));
+    }
+
+    static Int truncate (Type a) noexcept                   { return _mm512_cvttps_epi32 (a); }
+    static Type toFloat (Int i) noexcept                    { return _mm512_cvtepi32_ps (i); }
+    static Type gather (const float* table, Int i) noexcept { return _mm512_i32gather_ps (i, table, 4); }
+};
+
+//==============================================================================
+struct VecDouble
+{
+    using Sample = double;
+    using Type = __m512d;
+    using Mask = __mmask8;
+
+    static constexpr int size = 8;
+    static constexpr int alignment = 64;
+
+    static Type broadcast (double v) noexcept               { return _mm512_set1_pd (v); }
+    static Type lanes() noexcept                            { return _mm512_setr_pd (0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0); }
+    static Type load (const double* p) noexcept             { return _mm512_loadu_pd (p); }
+    static Type loadAligned (const double* p) noexcept      { return _mm512_load_pd (p); }
+    static void store (double* p, Type v) noexcept          { _mm512_storeu_pd (p, v); }
+    static void storeAligned (double* p, Type v) noexcept   { _mm512_store_pd (p, v); }
+
+    static Type add (Type a, Type b) noexcept               { return _mm512_add_pd (a, b); }
+    static Type sub (Type a, Type b) noexcept               { return _mm512_sub_pd (a, b); }
+    static Type mul (Type a, Type b) noexcept               { return _mm512_mul_pd (a, b); }
+    static Type div (Type a, Type b) noexcept               { return _mm512_div_pd (a, b); }
+    static Type max (Type a, Type b) noexcept               { return _mm512_max_pd (a, b); }
+    static Type min (Type a, Type b) noexcept               { return _mm512_min_pd (a, b); }
+    static Type abs (Type a) noexcept                       { return _mm512_abs_pd (a); }
+
+    static Type copySign (Type mag, Type sgn) noexcept
+    {
+        auto signBit = _mm512_set1_epi64 ((long long) 0x8000000000000000ull);
+        return _mm512_castsi512_pd (_mm512_or_si512 (_mm512_andnot_si512 (signBit, _mm512_castpd_si512 (mag)),
+                                                     _mm512_and_si512 (signBit, _mm512_castpd_si512 (sgn))));
+    }
+
+    static Mask greaterThan (Type a, Type b) noexcept       { return _mm512_cmp_pd_mask (a, b, _CMP_GT_OQ); }
+    static Mask lessThan (Type a, Type b) noexcept          { return _mm512_cmp_pd_mask (a, b, _CMP_LT_OQ); }
+    static Type select (Mask m, Type a, Type b) noexcept    { return _mm512_mask_blend_pd (m, b, a); }
+
+    static Type roundNearest (Type a) noexcept              { return _mm512_roundscale_pd (a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+    static Type pow2 (Type n) noexcept
+    {
+        auto biased = _mm256_add_epi32 (_mm512_cvtpd_epi32 (n), _mm256_set1_epi32 (1023));
+        return _mm512_castsi512_pd (_mm512_slli_epi64 (_mm512_cvtepi32_epi64 (biased), 52));
+    }
+};
+
+} // namespace avx512
+} // namespace pandamonium
+
+PANDAMONIUM_TARGET_END
+
+#endif
@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    VecNEON.h
+    Four float or two double lanes in a NEON register (AArch64).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SimdTarget.h"
+
+#if PANDAMONIUM_NEON
+
+namespace pandamonium
+{
+namespace neon
+{
+
+struct Vec
+{
+    using Sample = float;
+    using Type = float32x4_t;
+    using Mask = uint32x4_t;
+    using Int = int32x4_t;
+
+    static constexpr int size = 4;
+    static constexpr int alignment = 16;
+
+    static Type broadcast (float v) noexcept                { return vdupq_n_f32 (v); }
+    static Type lanes() noexcept                            { alignas (16) const float l[] = { 0.0f, 1.0f, 2.0f, 3.0f }; return vld1q_f32 (l); }
+    static Type load (const float* p) noexcept              { return vld1q_f32 (p); }
+    static Type loadAligned (const float* p) noexcept       { return vld1q_f32 (p); }
+    static void store (float* p, Type v) noexcept           { vst1q_f32 (p, v); }
+    static void storeAligned (float* p, Type v) noexcept    { vst1q_f32 (p, v); }
+
+    static Type add (Type a, Type b) noexcept               { return vaddq_f32 (a, b); }
+    static Type sub (Type a, Type b) noexcept               { return vsubq_f32 (a, b); }
+    static Type mul (Type a, Type b) noexcept               { return vmulq_f32 (a, b); }
+    static Type div (Type a, Type b) noexcept               { return vdivq_f32 (a, b); }
+    static Type max (Type a, Type b) noexcept               { return vmaxq_f32 (a, b); }
+    static Type min (Type a, Type b) noexcept               { return vminq_f32 (a, b); }
+    static Type abs (Type a) noexcept                       { return vabsq_f32 (a); }
+
+    static Type copySign (Type mag, Type sgn) noexcept
+    {
+        return vbslq_f32 (vdupq_n_u32 (0x80000000u), sgn, mag);
+    }
+
+    static Mask greaterThan (Type a, Type b) noexcept       { return vcgtq_f32 (a, b); }
+    static Mask lessThan (Type a, Type b) noexcept          { return vcltq_f32 (a, b); }
+    static Type select (Mask m, Type a, Type b) noexcept    { return vbslq_f32 (m, a, b); }
+
+    static Type roundNearest (Type a) noexcept              { return vrndnq_f32 (a); }
+
+    static Type pow2 (Type n) noexcept
+    {
+        return vreinterpretq_f32_s32 (vshlq_n_s32 (vaddq_s32 (vcvtq_s32_f32 (n), vdupq_n_s32 (127)), 23));
+    }
+
+    static Int truncate (Type a) noexcept                   { return vcvtq_s32_f32 (a); }
+    static Type toFloat (Int i) noexcept                    { return vcvtq_f32_s32 (i); }
+
+    static Type gather (const float* table, Int i) noexcept
+    {
+        alignas (16) const float values[] = { table[vgetq_lane_s32 (i, 0)], table[vgetq_lane_s32 (i, 1)],
+                                              table[vgetq_lane_s32 (i, 2)], table[vgetq_lane_s32 (i, 3)] };
+        return vld1q_f32 (values);
+    }
+};
+
+//==============================================================================
+struct VecDouble
+{
+    using Sample = double;
+    using Type = float64x2_t;
+    using Mask = uint64x2_t;
+
+    static constexpr int size = 2;
+    static constexpr int alignment = 16;
+
+    static Type broadcast (double v) noexcept               { return vdupq_n_f64 (v); }
+    static Type lanes() noexcept                            { alignas (16) const double l[] = { 0.0, 1.0 }; return vld1q_f64 (l); }
+    static Type load (const double* p) noexcept             { return vld1q_f64 (p); }
+    static Type loadAligned (const double* p) noexcept      { return vld1q_f64 (p); }
+    static void store (double* p, Type v) noexcept          { vst1q_f64 (p, v); }
+    static void storeAligned (double* p, Type v) noexcept   { vst1q_f64 (p, v); }
+
+    static Type add (Type a, Type b) noexcept               { return vaddq_f64 (a, b); }
+    static Type sub (Type a, Type b) noexcept               { return vsubq_f64 (a, b); }
+    static Type mul (Type a, Type b) noexcept               { return vmulq_f64 (a, b); }
+    static Type div (Type a, Type b) noexcept               { return vdivq_f64 (a, b); }
+    static Type max (Type a, Type b) noexcept               { return vmaxq_f64 (a, b); }
+    static Type min (Type a, Type b) noexcept               { return vminq_f64 (a, b); }
+    static Type abs (Type a) noexcept                       { return vabsq_f64 (a); }
+
+    static Type copySign (Type mag, Type sgn) noexcept
+    {
+        return vbslq_f64 (vdupq_n_u64 (0x8000000000000000ull), sgn, mag);
+    }
+
+    static Mask greaterThan (Type a, Type b) noexcept       { return vcgtq_f64 (a, b); }
+    static Mask lessThan (Type a, Type b) noexcept          { return vcltq_f64 (a, b); }
+    static Type select (Mask m, Type a, Type b) noexcept    { return vbslq_f64 (m, a, b); }
+
+    static Type roundNearest (Type a) noexcept              { return vrndnq_f64 (a); }
+
+    static Type pow2 (Type n) noexcept
+    {
+        return vreinterpretq_f64_s64 (vshlq_n_s64 (vaddq_s64 (vcvtq_s64_f64 (n), vdupq_n_s64 (1023)), 52));
+    }
+};
+
+} // namespace neon
+} // namespace pandamonium
+
+#endif
@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    VecSSE2.h
+    Four float or two double lanes in an SSE2 register.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SimdTarget.h"
+
+#if PANDAMONIUM_X86
+
+PANDAMONIUM_TARGET_BEGIN_SSE2
+
+namespace pandamonium
+{
+namespace sse2
+{
+
+struct Vec
+{
+    using Sample = float;
+    using Type = __m128;
+    using Mask = __m128;
+    using Int = __m128i;
+
+    static constexpr int size = 4;
+    static constexpr int alignment = 16;
+
+    static Type broadcast (float v) noexcept                { return _mm_set1_ps (v); }
+    static Type lanes() noexcept                            { return _mm_setr_ps (0.0f, 1.0f, 2.0f, 3.0f); }
+    static Type load (const float* p) noexcept              { return _mm_loadu_ps (p); }
+    static Type loadAligned (const float* p) noexcept       { return _mm_load_ps (p); }
+    static void store (float* p, Type v) noexcept           { _mm_storeu_ps (p, v); }
+    static void storeAligned (float* p, Type v) noexcept    { _mm_store_ps (p, v); }
+
+    static Type add (Type a, Type b) noexcept               { return _mm_add_ps (a, b); }
+    static Type sub (Type a, Type b) noexcept               { return _mm_sub_ps (a, b); }
+    static Type mul (Type a, Type b) noexcept               { return _mm_mul_ps (a, b); }
+    static Type div (Type a, Type b) noexcept               { return _mm_div_ps (a, b); }
+    static Type max (Type a, Type b) noexcept               { return _mm_max_ps (a, b); }
+    static Type min (Type a, Type b) noexcept               { return _mm_min_ps (a, b); }
+    static Type abs (Type a) noexcept                       { return _mm_andnot_ps (signMask(), a); }
+
+    static Type copySign (Type mag, Type sgn) noexcept
+    {
+        return _mm_or_ps (_mm_andnot_ps (signMask(), mag), _mm_and_ps (signMask(), sgn));
+    }
+
+    static Mask greaterThan (Type a, Type b) noexcept       { return _mm_cmpgt_ps (a, b); }
+    static Mask lessThan (Type a, Type b) noexcept          { return _mm_cmplt_ps (a, b); }
+
+    static Type select (Mask m, Type a, Type b) noexcept
+    {
+        return _mm_or_ps (_mm_and_ps (m, a), _mm_andnot_ps (m, b));
+    }
+
+    static Type roundNearest (Type a) noexcept              { return _mm_cvtepi32_ps (_mm_cvtps_epi32 (a)); }
+
+    static Type pow2 (Type n) noexcept
+    {
+        return _mm_castsi128_ps (_mm_slli_epi32 (_mm_add_epi32 (_mm_cvtps_epi32 (n), _mm_set1_epi32 (127)), 23));
+    }
+
+    static Int truncate (Type a) noexcept                   { return _mm_cvttps_epi32 (a); }
+    static Type toFloat (Int i) noexcept                    { return _mm_cvtepi32_ps (i); }
+
+    static Type gather (const float* table, Int i) noexcept
+    {
+        alignas (16) int index[4];
+        _mm_store_si128 (reinterpret_cast<__m128i*> (index), i);
+        return _mm_setr_ps (table[index[0]], table[index[1]], table[index[2]], table[index[3]]);
+    }
+
+private:
+    static Type signMask() noexcept                         { return _mm_set1_ps (-0.0f); }
+};
+
+//==============================================================================
+struct VecDouble
+{
+    using Sample = double;
+    using Type = __m128d;
+    using Mask = __m128d;
+
+    static constexpr int size = 2;
+    static constexpr int alignment = 16;
+
+    static Type broadcast (double v) noexcept               { return _mm_set1_pd (v); }
+    static Type lanes() noexcept                            { return _mm_setr_pd (0.0, 1.0); }
+    static Type load (const double* p) noexcept             { return _mm_loadu_pd (p); }
+    static Type loadAligned (const double* p) noexcept      { return _mm_load_pd (p); }
+    static void store (double* p, Type v) noexcept          { _mm_storeu_pd (p, v); }
+    static void storeAligned (double* p, Type v) noexcept   { _mm_store_pd (p, v); }
+
+    static Type add (Type a, Type b) noexcept               { return _mm_add_pd (a, b); }
+    static Type sub (Type a, Type b) noexcept               { return _mm_sub_pd (a, b); }
+    static Type mul (Type a, Type b) noexcept               { return _mm_mul_pd (a, b); }
+    static Type div (Type a, Type b) noexcept               { return _mm_div_pd (a, b); }
+    static Type max (Type a, Type b) noexcept               { return _mm_max_pd (a, b); }
+    static Type min (Type a, Type b) noexcept               { return _mm_min_pd (a, b); }
+    static Type abs (Type a) noexcept                       { return _mm_andnot_pd (signMask(), a); }
+
+    static Type copySign (Type mag, Type sgn) noexcept
+    {
+        return _mm_or_pd (_mm_andnot_pd (signMask(), mag), _mm_and_pd (signMask(), sgn));
+    }
+
+    static Mask greaterThan (Type a, Type b) noexcept       { return _mm_cmpgt_pd (a, b); }
+    static Mask lessThan (Type a, Type b) noexcept          { return _mm_cmplt_pd (a, b); }
+
+    static Type select (Mask m, Type a, Type b) noexcept
+    {
+        return _mm_or_pd (_mm_and_pd (m, a), _mm_andnot_pd (m, b));
+    }
+
+    // SSE2 has no double rounding instruction, but everything rounded here
+    // fits in an int
+    static Type roundNearest (Type a) noexcept              { return _mm_cvtepi32_pd (_mm_cvtpd_epi32 (a)); }
+
+    // the biased exponent is always positive, so zero-extending it to 64
+    // bits is enough
+    static Type pow2 (Type n) noexcept
+    {
+        auto biased = _mm_add_epi32 (_mm_cvtpd_epi32 (n), _mm_set1_epi32 (1023));
+        return _mm_castsi128_pd (_mm_slli_epi64 (_mm_unpacklo_epi32 (biased, _mm_setzero_si128()), 52));
+    }
+
+private:
+    static Type signMask() noexcept                         { return _mm_set1_pd (-0.0); }
+};
+
+} // namespace sse2
+} // namespace pandamonium
+
+PANDAMONIUM_TARGET_END
+
+#endif
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    VecScalar.h
+    One-lane "vectors" so the kernels have a plain C++ fallback.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+namespace pandamonium
+{
+namespace scalar
+{
+
+/** The interface every Vec in Source/DSP/Simd provides, with one lane. */
+struct Vec
+{
+    using Sample = float;
+    using Type = float;
+    using Mask = bool;
+    using Int = int;
+
+    static constexpr int size = 1;
+    static constexpr int alignment = alignof (float);
+
+    static Type broadcast (float v) noexcept                { return v; }
+    static Type lanes() noexcept                            { return 0.0f; }
+    static Type load (const float* p) noexcept              { return *p; }
+    static Type loadAligned (const float* p) noexcept       { return *p; }
+    static void store (float* p, Type v) noexcept           { *p = v; }
+    static void storeAligned (float* p, Type v) noexcept    { *p = v; }
+
+    static Type add (Type a, Type b) noexcept               { return a + b; }
+    static Type sub (Type a, Type b) noexcept               { return a - b; }
+    static Type mul (Type a, Type b) noexcept               { return a * b; }
+    static Type div (Type a, Type b) noexcept               { return a / b; }
+    static Type max (Type a, Type b) noexcept               { return std::max (a, b); }
+    static Type min (Type a, Type b) noexcept               { return std::min (a, b); }
+    static Type abs (Type a) noexcept                       { return std::abs (a); }
+    static Type copySign (Type mag, Type sgn) noexcept      { return std::copysign (mag, sgn); }
+
+    static Mask greaterThan (Type a, Type b) noexcept       { return a > b; }
+    static Mask lessThan (Type a, Type b) noexcept          { return a < b; }
+    static Type select (Mask m, Type a, Type b) noexcept    { return m ? a : b; }
+
+    /** Rounds to the nearest integer (ties to even), kept as a float. */
+    static Type roundNearest (Type a) noexcept              { return std::nearbyint (a); }
+
+    /** 2^n for an integral n in [-126, 127]. */
+    static Type pow2 (Type n) noexcept                      { return std::ldexp (1.0f, (int) n); }
+
+    /** Truncates towards zero. */
+    static Int truncate (Type a) noexcept                   { return (int) a; }
+    static Type toFloat (Int i) noexcept                    { return (float) i; }
+
+    /** Loads table[i] into each lane. */
+    static Type gather (const float* table, Int i) noexcept { return table[i]; }
+};
+
+//==============================================================================
+/** Vec for double precision, without the table lookups. */
+struct VecDouble
+{
+    using Sample = double;
+    using Type = double;
+    using Mask = bool;
+
+    static constexpr int size = 1;
+    static constexpr int alignment = alignof (double);
+
+    static Type broadcast (double v) noexcept               { return v; }
+    static Type lanes() noexcept                            { return 0.0; }
+    static Type load (const double* p) noexcept             { return *p; }
+    static Type loadAligned (const double* p) noexcept      { return *p; }
+    static void store (double* p, Type v) noexcept          { *p = v; }
+    static void storeAligned (double* p, Type v) noexcept   { *p = v; }
+
+    static Type add (Type a, Type b) noexcept               { return a + b; }
+    static Type sub (Type a, Type b) noexcept               { return a - b; }
+    static Type mul (Type a, Type b) noexcept               { return a * b; }
+    static Type div (Type a, Type b) noexcept               { return a / b; }
+    static Type max (Type a, Type b) noexcept               { return std::max (a, b); }
+    static Type min (Type a, Type b) noexcept               { return std::min (a, b); }
+    static Type abs (Type a) noexcept                       { return std::abs (a); }
+    static Type copySign (Type mag, Type sgn) noexcept      { return std::copysign (mag, sgn); }
+
+    static Mask greaterThan (Type a, Type b) noexcept       { return a > b; }
+    static Mask lessThan (Type a, Type b) noexcept          { return a < b; }
+    static Type select (Mask m, Type a, Type b) noexcept    { return m ? a : b; }
+
+    static Type roundNearest (Type a) noexcept              { return std::nearbyint (a); }
+
+    /** 2^n for an integral n in [-1022, 1023]. */
+    static Type pow2 (Type n) noexcept                      { return std::ldexp (1.0, (int) n); }
+};
+
+} // namespace scalar
+} // namespace pandamonium
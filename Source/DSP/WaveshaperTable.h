@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    WaveshaperTable.h
+    A lookup table for the Black mode curve, as an alternative to exp().
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace pandamonium
+{
+
+enum class Interpolation
+{
+    Linear = 0,
+    Cubic       // Catmull-Rom
+};
+
+constexpr int numInterpolations = 2;
+
+//==============================================================================
+/**
+    Black mode is sign(x) * (1 - exp(-|x| * fuzz)), which is g(u) = 1 - exp(-u)
+    evaluated at u = |x| * fuzz. The table holds g over [0, maxInput], so one
+    table serves every fuzz setting; beyond maxInput g is 1 to within float
+    precision and the lookup clamps there.
+
+    Tables are immutable once built. Building one allocates and calls exp()
+    a few thousand times, so do it off the audio thread and hand the result
+    over with a LockFreeSwap.
+*/
+class WaveshaperTable
+{
+public:
+    static constexpr float maxInput = 17.0f;
+
+    WaveshaperTable (int numPoints, Interpolation interpolation)
+        : _numPoints (std::max (4, numPoints)),
+          _interpolation (interpolation),
+          _scale ((float) (_numPoints - 1) / maxInput)
+    {
+        // one guard point before zero and two past the end, so cubic
+        // interpolation can always read p[-1] to p[2] without a branch
+        _points.resize ((size_t) _numPoints + 3);
+
+        for (int i = -1; i < _numPoints + 2; ++i)
+            _points[(size_t) (i + 1)] = (float) evaluate ((double) i / (double) _scale);
+
+        _maxError = measureMaxError();
+    }
+
+    /** Doubles the table size until the interpolation error is below
+        maxError, up to maxPoints.
+    */
+    static WaveshaperTable forAccuracy (double maxError, Interpolation interpolation, int maxPoints = 1 << 16)
+    {
+        for (int numPoints = 64;; numPoints *= 2)
+        {
+            WaveshaperTable table (numPoints, interpolation);
+
+            if (table.getMaxError() <= maxError || numPoints >= maxPoints)
+                return table;
+        }
+    }
+
+    //==============================================================================
+    int getNumPoints() const noexcept                   { return _numPoints; }
+    Interpolation getInterpolation() const noexcept     { return _interpolation; }
+
+    /** Table entries per unit of u. */
+    float getScale() const noexcept                     { return _scale; }
+
+    /** The largest table position a lookup may use. */
+    float getMaxPosition() const noexcept               { return (float) (_numPoints - 1); }
+
+    /** Points at g(0). p[-1] and p[numPoints + 1] are valid. */
+    const float* getPoints() const noexcept             { return _points.data() + 1; }
+
+    /** The worst absolute difference from 1 - exp(-u), found when the table
+        was built by sampling between every pair of points.
+    */
+    double getMaxError() const noexcept                 { return _maxError; }
+
+    //==============================================================================
+    /** The reference lookup, one value at a time. u must not be negative.
+        A NaN reads the last point, like anything past the end.
+    */
+    float lookup (float u) const noexcept
+    {
+        // not std::min, which passes a NaN through to index with
+        auto position = u * _scale < getMaxPosition() ? u * _scale : getMaxPosition();
+        auto i = (int) position;
+        auto f = position - (float) i;
+        auto* p = getPoints() + i;
+
+        if (_interpolation == Interpolation::Linear)
+            return p[0] + f * (p[1] - p[0]);
+
+        return p[0] + 0.5f * f * (p[1] - p[-1] + f * (2.0f * p[-1] - 5.0f * p[0] + 4.0f * p[1] - p[2]
+                                                        + f * (3.0f * (p[0] - p[1]) + p[2] - p[-1])));
+    }
+
+private:
+    static double evaluate (double u) noexcept     { return 1.0 - std::exp (-u); }
+
+    double measureMaxError() const noexcept
+    {
+        constexpr int stepsPerPoint = 16;
+        double worst = 0.0;
+
+        for (int i = 0; i <= (_numPoints - 1) * stepsPerPoint; ++i)
+        {
+            auto u = (double) i / (stepsPerPoint * (double) _scale);
+            worst = std::max (worst, std::abs ((double) lookup ((float) u) - evaluate (u)));
+        }
+
+        // past the end the table clamps to g (maxInput)
+        return std::max (worst, std::abs (1.0 - (double) getPoints()[_numPoints - 1]));
+    }
+
+    int _numPoints;
+    Interpolation _interpolation;
+    float _scale;
+    std::vector<float> _points;
+    double _maxError = 0.0;
+};
+
+} // namespace pandamonium
@@ -26,6 +26,16 @@ PandamoniumLookAndFeel::PandamoniumLookAndFeel()
     
     // labels
     setColour(juce::Label::textColourId, _gold);
+
+    // selectors
+    setColour (juce::ComboBox::backgroundColourId, _grey);
+    setColour (juce::ComboBox::outlineColourId, _grey);
+    setColour (juce::ComboBox::textColourId, _gold);
+    setColour (juce::ComboBox::arrowColourId, _gold);
+    setColour (juce::PopupMenu::backgroundColourId, _grey);
+    setColour (juce::PopupMenu::textColourId, _whitePanda);
+    setColour (juce::PopupMenu::highlightedBackgroundColourId, _blackPanda);
+    setColour (juce::PopupMenu::highlightedTextColourId, _gold);
     
     setDefaultSansSerifTypeface(_komikax.getTypefacePtr());
     
@@ -71,6 +81,16 @@ juce::Label* PandamoniumLookAndFeel::createSliderTextBox(juce::Slider& slider)
     return labelPtr;
 }
 
+juce::Font PandamoniumLookAndFeel::getComboBoxFont (juce::ComboBox&)
+{
+    return _komikax.withHeight (14.0f);
+}
+
+juce::Font PandamoniumLookAndFeel::getPopupMenuFont()
+{
+    return _komikax.withHeight (14.0f);
+}
+
 
 juce::String ModeSlider::getTextFromValue(double value)
 {
@@ -109,9 +129,91 @@ double ModeSlider::getValueFromText(const juce::String &text)
     return num;
 }
 
+//==============================================================================
+DiagnosticsOverlay::DiagnosticsOverlay (PandamoniumAudioProcessor& processor)
+    : _processor (processor)
+{
+    _saveButton.onClick = [this] { saveReport(); };
+    _resetButton.onClick = [this] { _processor.getBlockTiming().reset(); };
+
+    addAndMakeVisible (&_saveButton);
+    addAndMakeVisible (&_resetButton);
+}
+
+void DiagnosticsOverlay::paint (juce::Graphics& g)
+{
+    g.setColour (juce::Colours::black.withAlpha (0.75f));
+    g.fillRoundedRectangle (getLocalBounds().toFloat(), 8.0f);
+
+    g.setColour (juce::Colours::white);
+    g.setFont (juce::Font (juce::Font::getDefaultMonospacedFontName(), 14.0f, juce::Font::plain));
+
+    auto area = getLocalBounds().reduced (12, 8);
+    area.removeFromRight (90);
+
+    for (auto& line : _lines)
+        g.drawText (line, area.removeFromTop (18), juce::Justification::centredLeft);
+}
+
+void DiagnosticsOverlay::resized()
+{
+    auto buttons = getLocalBounds().reduced (12, 8).removeFromRight (80);
+    _saveButton.setBounds (buttons.removeFromTop (28));
+    buttons.removeFromTop (6);
+    _resetButton.setBounds (buttons.removeFromTop (28));
+}
+
+void DiagnosticsOverlay::visibilityChanged()
+{
+    if (isVisible())
+    {
+        timerCallback();
+        startTimerHz (4);
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
+void DiagnosticsOverlay::timerCallback()
+{
+    auto timing = _processor.getBlockTiming().getSnapshot();
+    auto percent = [] (double load) { return juce::String (load * 100.0, 2) + "%"; };
+
+    _lines.clearQuick();
+    _lines.add ("blocks " + juce::String ((juce::int64) timing.numBlocks)
+                + "   mean " + juce::String (timing.getMeanNanos() * 1.0e-3, 1) + " us"
+                + "   min " + juce::String ((double) timing.minNanos * 1.0e-3, 1)
+                + "   max " + juce::String ((double) timing.maxNanos * 1.0e-3, 1));
+    _lines.add ("load   mean " + percent (timing.getMeanLoad()) + "   max " + percent (timing.maxLoad));
+    _lines.add ("       p50 " + percent (timing.getLoadPercentile (0.5))
+                + "   p99 " + percent (timing.getLoadPercentile (0.99))
+                + "   p99.9 " + percent (timing.getLoadPercentile (0.999)));
+
+    repaint();
+}
+
+void DiagnosticsOverlay::saveReport()
+{
+    _fileChooser = std::make_unique<juce::FileChooser> ("Save timing report",
+                                                        juce::File::getSpecialLocation (juce::File::userDocumentsDirectory)
+                                                            .getChildFile ("Pandamonium timing.json"),
+                                                        "*.json");
+
+    _fileChooser->launchAsync (juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::warnAboutOverwriting,
+                               [this] (const juce::FileChooser& chooser)
+                               {
+                                   auto file = chooser.getResult();
+
+                                   if (file != juce::File())
+                                       _processor.writeBlockTimingReport (file);
+                               });
+}
+
 //==============================================================================
 PandamoniumAudioProcessorEditor::PandamoniumAudioProcessorEditor (PandamoniumAudioProcessor& parent, juce::AudioProcessorValueTreeState& vts)
-    : AudioProcessorEditor (&parent), audioProcessor (parent), valueTreeState(vts)
+    : AudioProcessorEditor (&parent), audioProcessor (parent), valueTreeState(vts), _diagnostics (parent)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -148,11 +250,27 @@ PandamoniumAudioProcessorEditor::PandamoniumAudioProcessorEditor (PandamoniumAud
     _modeSlider.setPopupDisplayEnabled(false, false, this);
     _modeAttachment.reset(new SliderAttachment(valueTreeState, "mode", _modeSlider));
 
+    _mixSlider.setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
+    _mixSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 150, 30);
+    _mixSlider.setPopupDisplayEnabled(false, false, this);
+    _mixSlider.setTextValueSuffix("% - Mix");
+    _mixAttachment.reset(new SliderAttachment(valueTreeState, "mix", _mixSlider));
+
+    setUpSelector (_oversamplingBox, _oversamplingLabel, "oversampling", _oversamplingAttachment);
+    setUpSelector (_oversamplingFilterBox, _oversamplingFilterLabel, "oversamplingFilter", _oversamplingFilterAttachment);
+    setUpSelector (_antialiasingBox, _antialiasingLabel, "antialiasing", _antialiasingAttachment);
+    setUpSelector (_offlineQualityBox, _offlineQualityLabel, "offlineQuality", _offlineQualityAttachment);
+
     // make components visible
     addAndMakeVisible(&_gainSlider);
     addAndMakeVisible(&_fuzzSlider);
     addAndMakeVisible(&_volumeSlider);
     addAndMakeVisible(&_modeSlider);
+    addAndMakeVisible(&_mixSlider);
+
+    // hidden until D is pressed
+    addChildComponent(&_diagnostics);
+    setWantsKeyboardFocus(true);
 
 }
 
@@ -160,6 +278,25 @@ PandamoniumAudioProcessorEditor::~PandamoniumAudioProcessorEditor()
 {
 }
 
+void PandamoniumAudioProcessorEditor::setUpSelector (juce::ComboBox& box, juce::Label& label, const juce::String& parameterID,
+                                                     std::unique_ptr<ComboBoxAttachment>& attachment)
+{
+    auto* parameter = valueTreeState.getParameter (parameterID);
+
+    // item IDs are the choice's index + 1, which is what the attachment expects
+    if (auto* choice = dynamic_cast<juce::AudioParameterChoice*> (parameter))
+        box.addItemList (choice->choices, 1);
+
+    label.setText (parameter->getName (32), juce::dontSendNotification);
+    label.setFont (14.0f);
+    label.setJustificationType (juce::Justification::centred);
+
+    attachment.reset (new ComboBoxAttachment (valueTreeState, parameterID, box));
+
+    addAndMakeVisible (&box);
+    addAndMakeVisible (&label);
+}
+
 //==============================================================================
 void PandamoniumAudioProcessorEditor::paint (juce::Graphics& g)
 {
@@ -171,11 +308,14 @@ void PandamoniumAudioProcessorEditor::resized()
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
     float sliderWidth = 130.0f;
-    
+
+    auto area = getLocalBounds();
+    auto selectors = area.removeFromBottom (56).reduced (10, 4);
+
     juce::Grid grid;
 
     grid.templateRows = { Track (Fr (1)), Track (Fr (1)) };
-    grid.templateColumns = { Track (Fr (1)), Track (Fr (1)) };
+    grid.templateColumns = { Track (Fr (1)), Track (Fr (1)), Track (Fr (1)) };
     
     grid.justifyContent = juce::Grid::JustifyContent::center;
     grid.justifyItems = juce::Grid::JustifyItems::center;
@@ -188,8 +328,35 @@ void PandamoniumAudioProcessorEditor::resized()
         juce::GridItem (_fuzzSlider).withWidth(sliderWidth).withHeight(sliderWidth),
         juce::GridItem (_volumeSlider).withWidth(sliderWidth).withHeight(sliderWidth),
         juce::GridItem (_modeSlider).withWidth(sliderWidth).withHeight(sliderWidth),
+        juce::GridItem (_mixSlider).withWidth(sliderWidth).withHeight(sliderWidth),
     };
 
-    grid.performLayout (getLocalBounds());
+    grid.performLayout (area);
+
+    // label over box, in four equal columns
+    auto columnWidth = selectors.getWidth() / 4;
+
+    for (auto [box, label] : { std::pair (&_oversamplingBox, &_oversamplingLabel),
+                               std::pair (&_oversamplingFilterBox, &_oversamplingFilterLabel),
+                               std::pair (&_antialiasingBox, &_antialiasingLabel),
+                               std::pair (&_offlineQualityBox, &_offlineQualityLabel) })
+    {
+        auto column = selectors.removeFromLeft (columnWidth).reduced (6, 0);
+        label->setBounds (column.removeFromTop (20));
+        box->setBounds (column);
+    }
+
+    _diagnostics.setBounds (getLocalBounds().removeFromBottom (96).reduced (10, 6));
     
 }
+
+bool PandamoniumAudioProcessorEditor::keyPressed (const juce::KeyPress& key)
+{
+    if (key.getTextCharacter() == 'd' || key.getTextCharacter() == 'D')
+    {
+        _diagnostics.setVisible (! _diagnostics.isVisible());
+        return true;
+    }
+
+    return false;
+}
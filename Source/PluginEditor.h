@@ -9,9 +9,11 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "BinaryData.h"
 #include "PluginProcessor.h"
 
 typedef juce::AudioProcessorValueTreeState::SliderAttachment SliderAttachment;
+typedef juce::AudioProcessorValueTreeState::ComboBoxAttachment ComboBoxAttachment;
 
 
 class PandamoniumLookAndFeel : public juce::LookAndFeel_V4
@@ -21,6 +23,8 @@ public:
     
     void drawRotarySlider (juce::Graphics& g, int x, int y, int width, int height, float sliderPos, const float rotaryStartAngle, const float rotaryEndAngle, juce::Slider&) override;
     juce::Label* createSliderTextBox(juce::Slider& slider) override;
+    juce::Font getComboBoxFont (juce::ComboBox&) override;
+    juce::Font getPopupMenuFont() override;
     
 private:
     // colors
@@ -43,6 +47,30 @@ public:
     double getValueFromText(const juce::String &text) override;
 };
 
+/** The processor's per-block timing, drawn over the artwork, with buttons
+    to save it as a report or start again. Only polls while it's showing.
+*/
+class DiagnosticsOverlay : public juce::Component, private juce::Timer
+{
+public:
+    explicit DiagnosticsOverlay (PandamoniumAudioProcessor& processor);
+
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+    void visibilityChanged() override;
+
+private:
+    void timerCallback() override;
+    void saveReport();
+
+    PandamoniumAudioProcessor& _processor;
+    juce::StringArray _lines;
+
+    juce::TextButton _saveButton { "Save..." };
+    juce::TextButton _resetButton { "Reset" };
+    std::unique_ptr<juce::FileChooser> _fileChooser;
+};
+
 //==============================================================================
 /**
 */
@@ -56,6 +84,9 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
 
+    /** D shows and hides the timing overlay. */
+    bool keyPressed (const juce::KeyPress& key) override;
+
 private:
 
     // This reference is provided as a quick way for your editor to
@@ -69,11 +100,37 @@ private:
     juce::Slider _fuzzSlider;
     juce::Slider _volumeSlider;
     ModeSlider _modeSlider;
+    juce::Slider _mixSlider;
 
     std::unique_ptr<SliderAttachment> _gainAttachment;
     std::unique_ptr<SliderAttachment> _fuzzAttachment;
     std::unique_ptr<SliderAttachment> _volumeAttachment;
     std::unique_ptr<SliderAttachment> _modeAttachment;
+    std::unique_ptr<SliderAttachment> _mixAttachment;
+
+    // the quality settings, along the bottom
+    juce::ComboBox _oversamplingBox;
+    juce::ComboBox _oversamplingFilterBox;
+    juce::ComboBox _antialiasingBox;
+    juce::ComboBox _offlineQualityBox;
+
+    juce::Label _oversamplingLabel;
+    juce::Label _oversamplingFilterLabel;
+    juce::Label _antialiasingLabel;
+    juce::Label _offlineQualityLabel;
+
+    std::unique_ptr<ComboBoxAttachment> _oversamplingAttachment;
+    std::unique_ptr<ComboBoxAttachment> _oversamplingFilterAttachment;
+    std::unique_ptr<ComboBoxAttachment> _antialiasingAttachment;
+    std::unique_ptr<ComboBoxAttachment> _offlineQualityAttachment;
+
+    /** Fills box with the choice parameter's options, names it with label
+        and attaches it.
+    */
+    void setUpSelector (juce::ComboBox& box, juce::Label& label, const juce::String& parameterID,
+                        std::unique_ptr<ComboBoxAttachment>& attachment);
+
+    DiagnosticsOverlay _diagnostics;
     
     juce::Image _background = juce::ImageCache::getFromMemory (BinaryData::pluginbackground_png, BinaryData::pluginbackground_pngSize);
 
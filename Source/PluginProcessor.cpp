@@ -9,6 +9,33 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 #include <cmath>
+#include <limits>
+
+namespace
+{
+    // how long bypass takes to fade in or out
+    constexpr double bypassFadeSeconds = 0.01;
+
+    // "oversampling" choices are 1x, 2x, 4x and 8x, i.e. 0 - 3 stages
+    constexpr int maxOversamplingStages = pandamonium::FuzzProcessor<float>::maxOversamplingStages;
+
+    // enough for 9.1.6 and up to 7th order ambisonics
+    constexpr int maxNumChannels = 64;
+
+    // the shortest sub-block a timestamped parameter change can make
+    constexpr int minAutomationBlockSize = 16;
+
+    // how often the message thread checks for a latency change to report
+    constexpr int latencyPollHz = 10;
+
+    // when set to a folder, every instance writes its timing report there
+    // as it's released
+    const char* const timingReportFolderVariable = "PANDAMONIUM_TIMING_DIR";
+
+    // the percentiles in a timing report
+    const std::pair<const char*, double> reportedPercentiles[] = { { "p50", 0.5 }, { "p90", 0.9 },
+                                                                   { "p99", 0.99 }, { "p99.9", 0.999 } };
+}
 
 //==============================================================================
 PandamoniumAudioProcessor::PandamoniumAudioProcessor()
@@ -48,6 +75,32 @@ PandamoniumAudioProcessor::PandamoniumAudioProcessor()
                                                          0,              // minimum value
                                                          2,              // maximum value
                                                          0),             // default value
+
+            std::make_unique<juce::AudioParameterChoice>("oversampling",            // parameterID
+                                                         "Oversampling",            // parameter name
+                                                         juce::StringArray { "Off", "2x", "4x", "8x" },
+                                                         0),             // default index
+
+            std::make_unique<juce::AudioParameterChoice>("oversamplingFilter",            // parameterID
+                                                         "Oversampling Filter",            // parameter name
+                                                         juce::StringArray { "Minimum Phase (IIR)", "Linear Phase (FIR)" },
+                                                         0),             // default index
+
+            std::make_unique<juce::AudioParameterChoice>("antialiasing",            // parameterID
+                                                         "Anti-aliasing",            // parameter name
+                                                         juce::StringArray { "Off", "ADAA" },
+                                                         0),             // default index
+
+            std::make_unique<juce::AudioParameterChoice>("offlineQuality",            // parameterID
+                                                         "Offline Quality",            // parameter name
+                                                         juce::StringArray { "Same as Realtime", "High" },
+                                                         1),             // default index
+
+            std::make_unique<juce::AudioParameterFloat>("mix",            // parameterID
+                                                         "Mix",            // parameter name
+                                                         0.0f,              // minimum value
+                                                         100.0f,              // maximum value
+                                                         100.0f),             // default value
         })
 #endif
 {
@@ -55,10 +108,24 @@ PandamoniumAudioProcessor::PandamoniumAudioProcessor()
     _fuzz = _parameters.getRawParameterValue("fuzz");
     _volume = _parameters.getRawParameterValue("volume");
     _mode = _parameters.getRawParameterValue("mode");
+    _oversampling = _parameters.getRawParameterValue("oversampling");
+    _oversamplingFilter = _parameters.getRawParameterValue("oversamplingFilter");
+    _antialiasing = _parameters.getRawParameterValue("antialiasing");
+    _offlineQuality = _parameters.getRawParameterValue("offlineQuality");
+    _mix = _parameters.getRawParameterValue("mix");
+
+    // in AutomatedParameter's order, for their ranges
+    const char* automatedIDs[] = { "gain", "fuzz", "volume", "mode", "mix" };
+
+    for (int i = 0; i < pandamonium::numAutomatedParameters; ++i)
+        _automatedParameters[(size_t) i] = _parameters.getParameter (automatedIDs[i]);
+
+    startTimerHz (latencyPollHz);
 }
 
 PandamoniumAudioProcessor::~PandamoniumAudioProcessor()
 {
+    stopTimer();
 }
 
 //==============================================================================
@@ -96,7 +163,12 @@ bool PandamoniumAudioProcessor::isMidiEffect() const
 
 double PandamoniumAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return getSampleRate() > 0.0 ? getTailLengthSamples() / getSampleRate() : 0.0;
+}
+
+int PandamoniumAudioProcessor::getTailLengthSamples() const
+{
+    return _processingTail.load();
 }
 
 int PandamoniumAudioProcessor::getNumPrograms()
@@ -128,12 +200,54 @@ void PandamoniumAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
+    auto numChannels = juce::jmax (1, getTotalNumInputChannels(), getTotalNumOutputChannels());
+
+    if (getProcessingPrecision() == doublePrecision)
+    {
+        _floatProcessor.release();
+        _doubleProcessor.setParameters (readParameters());
+        _doubleProcessor.prepare (sampleRate, samplesPerBlock, numChannels);
+        _doubleDryPath.delay.prepare (numChannels, samplesPerBlock, _doubleProcessor.getMaxLatencySamples());
+        _doubleDryPath.buffer.setSize (numChannels, samplesPerBlock);
+    }
+    else
+    {
+        _doubleProcessor.release();
+        _floatProcessor.setParameters (readParameters());
+        _floatProcessor.prepare (sampleRate, samplesPerBlock, numChannels);
+        _floatDryPath.delay.prepare (numChannels, samplesPerBlock, _floatProcessor.getMaxLatencySamples());
+        _floatDryPath.buffer.setSize (numChannels, samplesPerBlock);
+    }
+
+    _bypassSmoother.reset (sampleRate, bypassFadeSeconds);
+    _bypassSmoother.setCurrentAndTarget (1.0f);
+    _dspSkipped = false;
+
+    _highQuality = isRenderingHighQuality();
+    _automatedValues.reset();
+    _blockTiming.reset();
+
+    updateOversampling();
+
+    // not on the audio thread here, so the host can hear about it right away
+    setLatencySamples (getProcessingLatencySamples());
 }
 
 void PandamoniumAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    auto reportFolder = juce::SystemStats::getEnvironmentVariable (timingReportFolderVariable, {});
+
+    if (reportFolder.isNotEmpty() && _blockTiming.getSnapshot().numBlocks > 0)
+    {
+        auto name = juce::File::createLegalFileName ("Pandamonium " + getTrackName() + " "
+                                                     + juce::String::toHexString ((juce::pointer_sized_int) this) + ".json");
+        writeBlockTimingReport (juce::File (reportFolder).getChildFile (name));
+    }
+
+    _floatProcessor.release();
+    _doubleProcessor.release();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -143,12 +257,11 @@ bool PandamoniumAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // every channel goes through the same curve on its own, so any layout
+    // works, from mono through surround and ambisonics to plain discrete
+    auto output = layouts.getMainOutputChannelSet();
+
+    if (output.isDisabled() || output.size() > maxNumChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -162,8 +275,35 @@ bool PandamoniumAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
 }
 #endif
 
+bool PandamoniumAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
 void PandamoniumAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    processSamples (buffer, false);
+}
+
+void PandamoniumAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples (buffer, false);
+}
+
+void PandamoniumAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples (buffer, true);
+}
+
+void PandamoniumAudioProcessor::processBlockBypassed (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples (buffer, true);
+}
+
+template <typename SampleType>
+void PandamoniumAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer, bool bypassed)
+{
+    pandamonium::ScopedBlockTimer timer (_blockTiming, buffer.getNumSamples(), getSampleRate());
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -177,95 +317,210 @@ void PandamoniumAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+    // a bounce gets the expensive path without the session changing
+    _highQuality = isRenderingHighQuality();
+
+    auto& fuzz = getFuzzProcessor<SampleType>();
+    auto* blackModeTable = _blackModeTable.acquire();
+
+    fuzz.setBlackModeTable (_useBlackModeTable.load() && ! _highQuality ? blackModeTable : nullptr);
+    fuzz.setAntialiasing (_highQuality || _antialiasing->load() >= 0.5f);
+    updateOversampling();
+
+    // a host value that has moved since an event set it takes over again
+    for (int i = 0; i < pandamonium::numAutomatedParameters; ++i)
+        _automatedValues.dropOverridden ((pandamonium::AutomatedParameter) i, getHostValue ((pandamonium::AutomatedParameter) i));
+
+    _nextParameterEvent = 0;
+
+    // the dry path hears every block, so bypass can fade in at any time
+    auto& dryPath = getDryPath<SampleType>();
+
+    _bypassSmoother.setTarget (bypassed ? 0.0f : 1.0f);
+    auto crossfading = _bypassSmoother.isSmoothing();
+
+    // fully bypassed, a block costs two copies
+    if (bypassed && ! crossfading)
+    {
+        dryPath.delay.process (buffer.getArrayOfReadPointers(), buffer.getArrayOfWritePointers(),
+                               totalNumInputChannels, buffer.getNumSamples());
+
+        applyParameterEvents (std::numeric_limits<int>::max());
+        _parameterEvents.clear();
+        _dspSkipped = true;
+        return;
+    }
+
+    // coming back from bypass, nothing should ring on from before it
+    if (_dspSkipped)
+    {
+        fuzz.setParameters (readParameters());
+        fuzz.reset();
+        _dspSkipped = false;
+    }
+
+    auto numSamples = buffer.getNumSamples();
+    auto processed = false;
+    SampleType* channels[maxNumChannels];
+    SampleType* dry[maxNumChannels];
+
+    // the dry copy only holds as much as prepareToPlay() asked for, so a
+    // longer block from the host goes through a piece at a time
+    auto maxBlockSize = juce::jmax (1, dryPath.buffer.getNumSamples());
+
+    if (crossfading)
+        for (int channel = 0; channel < totalNumInputChannels; ++channel)
+            dry[channel] = dryPath.buffer.getWritePointer (channel);
+
+    for (int block = 0; block < numSamples; block += maxBlockSize)
     {
-        auto* channelData = buffer.getWritePointer (channel);
+        auto blockEnd = juce::jmin (numSamples, block + maxBlockSize);
+
+        for (int channel = 0; channel < totalNumInputChannels; ++channel)
+            channels[channel] = buffer.getWritePointer (channel, block);
 
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample) 
+        dryPath.delay.process (channels, crossfading ? dry : nullptr, totalNumInputChannels, blockEnd - block);
+
+        // timestamped changes split the block, each piece running with the
+        // values in effect from its start
+        for (int start = block, end = block; start < blockEnd; start = end)
         {
-            auto input = channelData[sample];
-
-            float gain = powf(10.0f, *_gain / 20.f); // decibels
-
-            float x = input * gain;
-
-            // add distortion
-            if (*_mode == 0)
-            {
-                if (x < 0)
-                {
-                    x = -1.0f + exp(x * *_fuzz);
-                }
-                else
-                {
-                    x = 1.0f - exp(-x * *_fuzz);
-                }
-            }
-
-            else if (*_mode == 1)
-            {
-                float threshold = 1.0f / 3.0f;
-                float fuzz = 6.0f * (*_fuzz / 30.0f);
-
-                if (x > threshold)
-                {
-                    if (x > 2.0f * threshold)
-                    {
-                        x = 1.0f;
-                    }
-                    else
-                    {
-                        x = (3.0f - (2.0f - fuzz*x) * (2.0f - fuzz*x)) / 3.0f;
-                    }
-                }
-                else if (x < -threshold)
-                {
-                    if (x < -2.0f * threshold)
-                    {
-                        x = -1.0f;
-                    }
-                    else
-                    {
-                        x = -(3.0f - (2.0f - fuzz*x) * (2.0f - fuzz*x)) / 3.0f;
-                    }
-                }
-                else
-                {
-                    x *= 2.0f;
-                }
-
-                x /= 2.0f;
-           
-            }
-
-            else
-            {
-                float threshold = 1 - *_fuzz / 30.0f;
-
-                if (x > threshold) 
-                {
-                    x = 1;
-                }
-                else if (x < -threshold)
-                {
-                    x = -1;
-                }
-            }
-                    
-            float volume = powf(10.0f, *_volume / 20.f); // decibels
-            auto output = x * volume;
-
-            channelData[sample] = output;
+            applyParameterEvents (start);
+            end = juce::jmin (blockEnd, getNextParameterBoundary (start));
+
+            for (int channel = 0; channel < totalNumInputChannels; ++channel)
+                channels[channel] = buffer.getWritePointer (channel, start);
+
+            fuzz.setParameters (readParameters());
+            processed |= fuzz.process (channels, totalNumInputChannels, end - start);
         }
+
+        if (crossfading)
+            crossfadeWithDry (buffer, block, blockEnd - block, dryPath.buffer, totalNumInputChannels);
+    }
+
+    // the fuzz skips silent blocks once nothing is left ringing, and
+    // clearing the buffer flags it as silent (AudioBuffer::hasBeenCleared)
+    // for anything downstream that looks. A skipped block is already
+    // zeroed, so only the flag is missing, and mid-fade the dry is still
+    // there.
+    if (! processed && ! crossfading)
+        buffer.clear();
+
+    // anything timed at or past the end still counts for the next block
+    applyParameterEvents (std::numeric_limits<int>::max());
+    _parameterEvents.clear();
+}
+
+template <typename SampleType>
+void PandamoniumAudioProcessor::crossfadeWithDry (juce::AudioBuffer<SampleType>& buffer, int bufferStart, int numSamples,
+                                                  const juce::AudioBuffer<SampleType>& dry, int numChannels)
+{
+    for (int start = 0; start < numSamples;)
+    {
+        auto length = _bypassSmoother.getSegmentLength (numSamples - start);
+        auto wet = _bypassSmoother.advance (length);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* out = buffer.getWritePointer (channel, bufferStart + start);
+            auto* in = dry.getReadPointer (channel, start);
+
+            for (int i = 0; i < length; ++i)
+                out[i] = in[i] + (out[i] - in[i]) * (SampleType) (wet.start + wet.step * (float) i);
+        }
+
+        start += length;
+    }
+}
+
+void PandamoniumAudioProcessor::updateOversampling()
+{
+    auto stages = _highQuality ? maxOversamplingStages
+                               : juce::jlimit (0, maxOversamplingStages, (int) _oversampling->load());
+    auto filter = (pandamonium::OversamplingFilter) juce::jlimit (0, 1, (int) _oversamplingFilter->load());
+
+    _floatProcessor.setOversampling (stages, filter);
+    _doubleProcessor.setOversampling (stages, filter);
+
+    // the processor that wasn't prepared has no latency
+    auto latency = juce::jmax (_floatProcessor.getLatencySamples(), _doubleProcessor.getLatencySamples());
+
+    _floatDryPath.delay.setDelay (latency);
+    _doubleDryPath.delay.setDelay (latency);
+    _processingLatency = latency;
+    _processingTail = juce::jmax (_floatProcessor.getTailLengthSamples(), _doubleProcessor.getTailLengthSamples());
+}
+
+void PandamoniumAudioProcessor::timerCallback()
+{
+    setLatencySamples (getProcessingLatencySamples());
+}
+
+int PandamoniumAudioProcessor::getProcessingLatencySamples() const
+{
+    return _processingLatency.load();
+}
+
+pandamonium::FuzzParameters PandamoniumAudioProcessor::readParameters() const
+{
+    using pandamonium::AutomatedParameter;
+
+    auto get = [this] (AutomatedParameter parameter) { return _automatedValues.get (parameter, getHostValue (parameter)); };
+
+    return pandamonium::FuzzParameters::fromRaw (get (AutomatedParameter::Gain), get (AutomatedParameter::Fuzz),
+                                                 get (AutomatedParameter::Volume), get (AutomatedParameter::Mode),
+                                                 get (AutomatedParameter::Mix));
+}
+
+float PandamoniumAudioProcessor::getHostValue (pandamonium::AutomatedParameter parameter) const
+{
+    switch (parameter)
+    {
+        case pandamonium::AutomatedParameter::Gain:     return _gain->load();
+        case pandamonium::AutomatedParameter::Fuzz:     return _fuzz->load();
+        case pandamonium::AutomatedParameter::Volume:   return _volume->load();
+        case pandamonium::AutomatedParameter::Mode:     return _mode->load();
+        case pandamonium::AutomatedParameter::Mix:      return _mix->load();
+    }
+
+    return 0.0f;
+}
+
+bool PandamoniumAudioProcessor::addParameterEvent (int sampleOffset, pandamonium::AutomatedParameter parameter, float value)
+{
+    if (std::isnan (value))
+        return false;
+
+    // the host's own values never leave the parameter's range, or come
+    // between Mode's steps, and the kernels count on that
+    auto& range = _automatedParameters[(size_t) parameter]->getNormalisableRange();
+
+    return _parameterEvents.add ({ juce::jmax (0, sampleOffset), parameter, range.snapToLegalValue (value) });
+}
+
+void PandamoniumAudioProcessor::applyParameterEvents (int upToSample)
+{
+    for (; _nextParameterEvent < _parameterEvents.size(); ++_nextParameterEvent)
+    {
+        auto& event = _parameterEvents[_nextParameterEvent];
+
+        if (event.sampleOffset > upToSample)
+            break;
+
+        _automatedValues.set (event.parameter, event.value, getHostValue (event.parameter));
     }
 }
 
+int PandamoniumAudioProcessor::getNextParameterBoundary (int subBlockStart) const
+{
+    if (_nextParameterEvent >= _parameterEvents.size())
+        return std::numeric_limits<int>::max();
+
+    // events closer together than that are held back to the next boundary
+    return juce::jmax (_parameterEvents[_nextParameterEvent].sampleOffset, subBlockStart + minAutomationBlockSize);
+}
+
 //==============================================================================
 bool PandamoniumAudioProcessor::hasEditor() const
 {
@@ -299,6 +554,18 @@ void PandamoniumAudioProcessor::setStateInformation (const void* data, int sizeI
             _parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
 }
 
+void PandamoniumAudioProcessor::updateTrackProperties (const TrackProperties& properties)
+{
+    const juce::ScopedLock lock (_trackNameLock);
+    _trackName = properties.name;
+}
+
+juce::String PandamoniumAudioProcessor::getTrackName() const
+{
+    const juce::ScopedLock lock (_trackNameLock);
+    return _trackName;
+}
+
 //==============================================================================
 // This creates new instances of the plugin..
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -347,3 +614,135 @@ void PandamoniumAudioProcessor::setMode(float mode)
     *_mode = mode;
 }
 
+float PandamoniumAudioProcessor::getOversampling()
+{
+    return *_oversampling;
+}
+
+void PandamoniumAudioProcessor::setOversampling(float oversampling)
+{
+    *_oversampling = oversampling;
+}
+
+float PandamoniumAudioProcessor::getOversamplingFilter()
+{
+    return *_oversamplingFilter;
+}
+
+void PandamoniumAudioProcessor::setOversamplingFilter(float filter)
+{
+    *_oversamplingFilter = filter;
+}
+
+float PandamoniumAudioProcessor::getAntialiasing()
+{
+    return *_antialiasing;
+}
+
+void PandamoniumAudioProcessor::setAntialiasing(float antialiasing)
+{
+    *_antialiasing = antialiasing;
+}
+
+float PandamoniumAudioProcessor::getOfflineQuality()
+{
+    return *_offlineQuality;
+}
+
+void PandamoniumAudioProcessor::setOfflineQuality(float quality)
+{
+    *_offlineQuality = quality;
+}
+
+float PandamoniumAudioProcessor::getMix()
+{
+    return *_mix;
+}
+
+void PandamoniumAudioProcessor::setMix(float mix)
+{
+    *_mix = mix;
+}
+
+bool PandamoniumAudioProcessor::isRenderingHighQuality() const
+{
+    return isNonRealtime() && _offlineQuality->load() >= 0.5f;
+}
+
+pandamonium::BlockTimingRecorder& PandamoniumAudioProcessor::getBlockTiming()
+{
+    return _blockTiming;
+}
+
+juce::var PandamoniumAudioProcessor::getBlockTimingReport() const
+{
+    auto timing = _blockTiming.getSnapshot();
+    auto* report = new juce::DynamicObject();
+
+    report->setProperty ("track", getTrackName());
+    report->setProperty ("sampleRate", getSampleRate());
+    report->setProperty ("blockSize", getBlockSize());
+    report->setProperty ("channels", getTotalNumInputChannels());
+    report->setProperty ("doublePrecision", getProcessingPrecision() == doublePrecision);
+    report->setProperty ("latencySamples", getProcessingLatencySamples());
+    report->setProperty ("instructionSet", juce::String (pandamonium::getInstructionSetName (getInstructionSet())));
+    report->setProperty ("blocks", (juce::int64) timing.numBlocks);
+    report->setProperty ("meanMs", timing.getMeanNanos() * 1.0e-6);
+    report->setProperty ("minMs", (double) timing.minNanos * 1.0e-6);
+    report->setProperty ("maxMs", (double) timing.maxNanos * 1.0e-6);
+    report->setProperty ("meanLoad", timing.getMeanLoad());
+    report->setProperty ("maxLoad", timing.maxLoad);
+
+    for (auto& percentile : reportedPercentiles)
+        report->setProperty (percentile.first, timing.getLoadPercentile (percentile.second));
+
+    // only the bins anything landed in, as [upper load, blocks]
+    juce::Array<juce::var> histogram;
+
+    for (int bin = 0; bin < pandamonium::BlockTimingRecorder::numBins; ++bin)
+        if (timing.histogram[bin] > 0)
+            histogram.add (juce::Array<juce::var> { pandamonium::BlockTimingRecorder::getBinUpperLoad (bin), (juce::int64) timing.histogram[bin] });
+
+    report->setProperty ("loadHistogram", histogram);
+    return report;
+}
+
+bool PandamoniumAudioProcessor::writeBlockTimingReport (const juce::File& file) const
+{
+    return file.replaceWithText (juce::JSON::toString (getBlockTimingReport()));
+}
+
+pandamonium::InstructionSet PandamoniumAudioProcessor::getInstructionSet() const
+{
+    return _floatProcessor.getInstructionSet();
+}
+
+//==============================================================================
+void PandamoniumAudioProcessor::setBlackModeTable (int numPoints, pandamonium::Interpolation interpolation)
+{
+    if (numPoints <= 0)
+    {
+        _useBlackModeTable = false;
+        _blackModeTableError = 0.0;
+        return;
+    }
+
+    publishBlackModeTable (std::make_unique<pandamonium::WaveshaperTable> (numPoints, interpolation));
+}
+
+void PandamoniumAudioProcessor::setBlackModeTableForAccuracy (double maxError, pandamonium::Interpolation interpolation)
+{
+    publishBlackModeTable (std::make_unique<pandamonium::WaveshaperTable> (pandamonium::WaveshaperTable::forAccuracy (maxError, interpolation)));
+}
+
+double PandamoniumAudioProcessor::getBlackModeTableError() const
+{
+    return _blackModeTableError;
+}
+
+void PandamoniumAudioProcessor::publishBlackModeTable (std::unique_ptr<pandamonium::WaveshaperTable> table)
+{
+    _blackModeTableError = table->getMaxError();
+    _blackModeTable.publish (std::move (table));
+    _useBlackModeTable = true;
+}
@@ -9,11 +9,24 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "DSP/BlockTiming.h"
+#include "DSP/FuzzKernels.h"
+#include "DSP/FuzzParameters.h"
+#include "DSP/FuzzProcessor.h"
+#include "DSP/LatencyDelay.h"
+#include "DSP/LinearSmoother.h"
+#include "DSP/LockFreeSwap.h"
+#include "DSP/ParameterEvents.h"
+#include "DSP/SilenceDetection.h"
+#include "DSP/WaveshaperTable.h"
 
 //==============================================================================
-/**
+/** The plugin around pandamonium::FuzzProcessor, which does all the DSP.
+    This side has the parameters, presets, bypass, timestamped automation
+    and timing.
 */
-class PandamoniumAudioProcessor  : public juce::AudioProcessor
+class PandamoniumAudioProcessor  : public juce::AudioProcessor,
+                                   private juce::Timer
 {
 public:
     //==============================================================================
@@ -29,6 +42,21 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    /** Passes the input through delayed by the reported latency, so it lines
+        up with what processBlock would have produced, and crossfades to and
+        from the processed signal over a few milliseconds. Once the fade is
+        over the DSP doesn't run at all.
+    */
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    /** Double buffers go through double kernels and oversamplers rather than
+        being converted to float, so call setProcessingPrecision() before
+        prepareToPlay() to get them.
+    */
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -53,6 +81,9 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    /** Remembers the track name for timing reports. */
+    void updateTrackProperties (const TrackProperties& properties) override;
+
     //==============================================================================
     float getGain();
     void setGain(float gain);
@@ -66,6 +97,89 @@ public:
     float getMode();
     void setMode(float mode);
 
+    float getOversampling();
+    void setOversampling(float oversampling);
+
+    float getOversamplingFilter();
+    void setOversamplingFilter(float filter);
+
+    float getAntialiasing();
+    void setAntialiasing(float antialiasing);
+
+    float getOfflineQuality();
+    void setOfflineQuality(float quality);
+
+    /** Dry/wet balance in percent, 100 being fully wet. The dry side is
+        mixed in by the kernels at whatever rate they run, so when
+        oversampling it goes through the same filters as the wet side and
+        stays aligned with it without a separate delay.
+    */
+    float getMix();
+    void setMix(float mix);
+
+    /** True while the host is rendering offline and the offline quality
+        parameter asks for the high quality path: 8x oversampling with ADAA,
+        and Black mode always computing exp() rather than using a table.
+    */
+    bool isRenderingHighQuality() const;
+
+    /** Schedules a change of parameter sampleOffset samples into the next
+        processBlock, in the parameter's own units. Call it on the audio
+        thread before that processBlock. Changes land on sub-block
+        boundaries at least 16 samples apart, so dense automation can't
+        break the block up into single samples. Values are clamped to the
+        parameter's range, and Mode's rounded to a whole mode. Returns false
+        if the block has no room for more, or value is NaN.
+
+        Nothing in the plugin itself calls this, as JUCE doesn't pass hosts'
+        sample accurate automation on. It's for tools driving the processor
+        with timestamped automation of their own, like the benchmark.
+    */
+    bool addParameterEvent (int sampleOffset, pandamonium::AutomatedParameter parameter, float value);
+
+    /** The latency processBlock is running with right now. The host is told
+        about a change on the message thread shortly afterwards, so until
+        then getLatencySamples() can lag behind this.
+    */
+    int getProcessingLatencySamples() const;
+
+    /** How long the output can keep going after the input stops with the
+        oversampling processBlock is running with right now, measured from
+        the filters' own decay.
+    */
+    int getTailLengthSamples() const;
+
+    /** How long each processBlock has taken against its real-time budget,
+        since preparing or the last reset. Safe to read from any thread.
+    */
+    pandamonium::BlockTimingRecorder& getBlockTiming();
+
+    /** The timing statistics and this instance's setup as JSON, for finding
+        the heavy instances in a big session.
+    */
+    juce::var getBlockTimingReport() const;
+    bool writeBlockTimingReport (const juce::File& file) const;
+
+    /** The instruction set processBlock's kernels were picked for. */
+    pandamonium::InstructionSet getInstructionSet() const;
+
+    /** Makes Black mode read its curve from a lookup table instead of calling
+        exp(), or pass 0 points to go back to exp(). The table is built on the
+        calling thread, so never call this from the audio thread; processBlock
+        picks it up at the start of its next block.
+    */
+    void setBlackModeTable (int numPoints, pandamonium::Interpolation interpolation);
+
+    /** As setBlackModeTable(), with the smallest table that is within
+        maxError of exp().
+    */
+    void setBlackModeTableForAccuracy (double maxError, pandamonium::Interpolation interpolation);
+
+    /** The worst difference between the current table and exp(), or 0 when
+        Black mode isn't using a table.
+    */
+    double getBlackModeTableError() const;
+
 private:
     juce::AudioProcessorValueTreeState _parameters;
 
@@ -73,6 +187,105 @@ private:
     std::atomic<float>* _fuzz = nullptr;
     std::atomic<float>* _volume = nullptr;
     std::atomic<float>* _mode = nullptr;
+    std::atomic<float>* _oversampling = nullptr;
+    std::atomic<float>* _oversamplingFilter = nullptr;
+    std::atomic<float>* _antialiasing = nullptr;
+    std::atomic<float>* _offlineQuality = nullptr;
+    std::atomic<float>* _mix = nullptr;
+
+    // written by the audio thread, read by the editor and reports
+    pandamonium::BlockTimingRecorder _blockTiming;
+
+    // from the host, which may call from any thread but the audio one
+    juce::String _trackName;
+    juce::CriticalSection _trackNameLock;
+
+    juce::String getTrackName() const;
+
+    // optional lookup table for Black mode, built on the message thread
+    pandamonium::LockFreeSwap<pandamonium::WaveshaperTable> _blackModeTable;
+    std::atomic<bool> _useBlackModeTable { false };
+    double _blackModeTableError = 0.0;
+
+    void publishBlackModeTable (std::unique_ptr<pandamonium::WaveshaperTable> table);
+
+    // the fuzz itself, with kernels chosen once for this CPU (or
+    // PANDAMONIUM_ISA). Only the host's processing precision is ever
+    // prepared; the other one stays empty and reports no latency.
+    pandamonium::FuzzProcessor<float> _floatProcessor;
+    pandamonium::FuzzProcessor<double> _doubleProcessor;
+
+    template <typename SampleType>
+    pandamonium::FuzzProcessor<SampleType>& getFuzzProcessor() noexcept
+    {
+        if constexpr (std::is_same<SampleType, double>::value)
+            return _doubleProcessor;
+        else
+            return _floatProcessor;
+    }
+
+    // set by the audio thread when the oversampling changes. Telling the
+    // host takes locks and posts messages, so that waits for the timer.
+    std::atomic<int> _processingLatency { 0 };
+
+    // how long the oversampling setup rings, which follows it for the host
+    std::atomic<int> _processingTail { 0 };
+
+    void timerCallback() override;
+
+    // the input delayed by the latency, fed on every block so bypass can
+    // start at any time, and a copy of it for crossfading
+    template <typename SampleType>
+    struct DryPath
+    {
+        pandamonium::LatencyDelay<SampleType> delay;
+        juce::AudioBuffer<SampleType> buffer;
+    };
+
+    DryPath<float> _floatDryPath;
+    DryPath<double> _doubleDryPath;
+
+    template <typename SampleType>
+    DryPath<SampleType>& getDryPath() noexcept
+    {
+        if constexpr (std::is_same<SampleType, double>::value)
+            return _doubleDryPath;
+        else
+            return _floatDryPath;
+    }
+
+    // 1 while processing, 0 while bypassed, and in between while fading
+    pandamonium::LinearSmoother _bypassSmoother;
+    bool _dspSkipped = false;
+
+    template <typename SampleType>
+    void crossfadeWithDry (juce::AudioBuffer<SampleType>& buffer, int bufferStart, int numSamples,
+                           const juce::AudioBuffer<SampleType>& dry, int numChannels);
+
+    // decided at the start of each block; everything it switches on was
+    // allocated in prepareToPlay along with the realtime path
+    bool _highQuality = false;
+
+    // timestamped changes for the coming block, and the values they leave
+    // in effect until the host's own value moves
+    pandamonium::ParameterEventQueue _parameterEvents { maxParameterEventsPerBlock };
+    pandamonium::AutomatedValues _automatedValues;
+    int _nextParameterEvent = 0;
+
+    // the parameters behind the events, for clamping them to range
+    std::array<juce::RangedAudioParameter*, pandamonium::numAutomatedParameters> _automatedParameters {};
+
+    static constexpr int maxParameterEventsPerBlock = 1024;
+
+    float getHostValue (pandamonium::AutomatedParameter parameter) const;
+    void applyParameterEvents (int upToSample);
+    int getNextParameterBoundary (int subBlockStart) const;
+
+    pandamonium::FuzzParameters readParameters() const;
+    void updateOversampling();
+
+    template <typename SampleType>
+    void processSamples (juce::AudioBuffer<SampleType>& buffer, bool bypassed);
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PandamoniumAudioProcessor)
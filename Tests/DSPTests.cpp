@@ -0,0 +1,355 @@
+/*
+  ==============================================================================
+
+    DSPTests.cpp
+    Checks the header-only core on its own, without JUCE.
+
+  ==============================================================================
+*/
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include "FuzzProcessor.h"
+
+using namespace pandamonium;
+
+namespace
+{
+    // every allocation while this is set counts against process()
+    std::atomic<bool> countingAllocations { false };
+    std::atomic<int> numAllocations { 0 };
+
+    int numFailures = 0;
+
+    void expect (bool condition, const char* what)
+    {
+        if (! condition)
+        {
+            std::printf ("FAILED: %s\n", what);
+            ++numFailures;
+        }
+    }
+
+    const char* getFilterName (OversamplingFilter filter)
+    {
+        return filter == OversamplingFilter::MinimumPhase ? "minimum phase" : "linear phase";
+    }
+
+    //==============================================================================
+    /** A low sine up and straight back down should come out as itself,
+        getLatencySamples() later, and noticeably further from it a sample
+        either side.
+    */
+    template <typename Sample>
+    void testLatencyAlignment (int numStages, OversamplingFilter filter)
+    {
+        const int blockSize = 512;
+        const int numSamples = blockSize * 94;
+        const int settled = 10000;
+
+        Oversampler<Sample> oversampler;
+        oversampler.prepare (1, blockSize);
+        oversampler.setup (numStages, filter);
+
+        const auto latency = oversampler.getLatencySamples();
+        std::vector<Sample> input ((size_t) numSamples), output ((size_t) numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+            input[(size_t) i] = (Sample) std::sin (2.0 * detail::pi * 100.0 / 48000.0 * i);
+
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            const Sample* in = input.data() + start;
+            Sample* out = output.data() + start;
+
+            oversampler.upsample (&in, 1, blockSize);
+            oversampler.downsample (&out, 1, blockSize);
+        }
+
+        auto errorAt = [&] (int delay)
+        {
+            double error = 0.0;
+
+            for (int i = settled; i < numSamples; ++i)
+                error = std::max (error, std::abs ((double) output[(size_t) i] - (double) input[(size_t) (i - delay)]));
+
+            return error;
+        };
+
+        const auto error = errorAt (latency);
+        const auto nearest = std::min (errorAt (latency - 1), errorAt (latency + 1));
+
+        std::printf ("%s, %dx %s: latency %d, error %.2e (%.2e a sample off)\n", sizeof (Sample) == 4 ? "float" : "double",
+                     1 << numStages, getFilterName (filter), latency, error, nearest);
+
+        expect (error < 1.0e-3, "oversampling lines up with its reported latency");
+        expect (error * 10.0 < nearest, "the reported latency is the closest whole sample");
+    }
+
+    //==============================================================================
+    void testNoAllocationsInProcess()
+    {
+        const int numSamples = 1000;
+
+        FuzzProcessor<float> processor;
+        processor.setParameters (FuzzParameters::fromRaw (12.0f, 20.0f, 0.0f, 0.0f, 100.0f));
+        processor.prepare (48000.0, 256, 2);
+
+        std::vector<float> left ((size_t) numSamples), right ((size_t) numSamples);
+        float* channels[] = { left.data(), right.data() };
+
+        auto fill = [&]
+        {
+            for (int i = 0; i < numSamples; ++i)
+                left[(size_t) i] = right[(size_t) i] = 0.3f * std::sin ((float) i * 0.05f);
+        };
+
+        numAllocations = 0;
+        countingAllocations = true;
+
+        for (int stages = 0; stages <= FuzzProcessor<float>::maxOversamplingStages; ++stages)
+        {
+            for (auto filter : { OversamplingFilter::MinimumPhase, OversamplingFilter::LinearPhase })
+            {
+                for (int mode = 0; mode < 3; ++mode)
+                {
+                    fill();
+                    processor.setOversampling (stages, filter);
+                    processor.setAntialiasing (mode == 1);
+                    processor.setParameters (FuzzParameters::fromRaw (3.0f * (float) stages, 5.0f, 2.0f, (float) mode, 50.0f));
+                    processor.process (channels, 2, numSamples);
+
+                    // and through silence, skipped and not
+                    std::fill (left.begin(), left.end(), 0.0f);
+                    std::fill (right.begin(), right.end(), 0.0f);
+                    processor.process (channels, 2, numSamples);
+                    processor.process (channels, 2, numSamples);
+                }
+            }
+        }
+
+        countingAllocations = false;
+
+        std::printf ("allocations in process(): %d\n", numAllocations.load());
+        expect (numAllocations == 0, "process() never allocates");
+    }
+
+    //==============================================================================
+    /** With no oversampling the processor should be nothing but the kernel,
+        to the bit.
+    */
+    template <typename Sample>
+    void testMatchesKernelsAt1x()
+    {
+        const int numSamples = 1000;
+
+        for (int mode = 0; mode < 3; ++mode)
+        {
+            const auto parameters = FuzzParameters::fromRaw (12.0f, 20.0f, 3.0f, (float) mode, 100.0f);
+
+            FuzzProcessor<Sample> processor;
+            processor.setParameters (parameters);
+            processor.prepare (48000.0, 256, 1);
+
+            std::vector<Sample> processed ((size_t) numSamples);
+
+            for (int i = 0; i < numSamples; ++i)
+                processed[(size_t) i] = (Sample) (0.3 * std::sin (i * 0.05));
+
+            auto expected = processed;
+            auto kernel = getPreferredFuzzKernels().get<Sample> (parameters.mode);
+            kernel (expected.data(), numSamples, { parameters.gain, 0.0f }, { parameters.volume, 0.0f },
+                    { parameters.mix, 0.0f }, parameters.fuzz);
+
+            auto* channel = processed.data();
+            processor.process (&channel, 1, numSamples);
+
+            expect (processed == expected, "1x output is the kernel's, bit for bit");
+        }
+    }
+
+    //==============================================================================
+    /** NaN and inf from a host mustn't reach an integer conversion in any
+        kernel (run under UBSan to see that), and Black, which is bounded
+        whatever goes in, should stay bounded.
+    */
+    template <typename Sample>
+    void testNonFiniteInput (InstructionSet isa)
+    {
+        constexpr int numSamples = 37;
+        const auto nan = std::numeric_limits<Sample>::quiet_NaN();
+        const auto inf = std::numeric_limits<Sample>::infinity();
+        const Sample awkward[] = { nan, inf, -inf, -nan, Sample (1.0e30), Sample (-1.0e30), Sample (0.5) };
+
+        auto& kernels = getFuzzKernels (isa);
+        const Ramp unity { 1.0f, 0.0f };
+
+        auto fill = [&] (std::vector<Sample>& data)
+        {
+            for (int i = 0; i < numSamples; ++i)
+                data[(size_t) i] = awkward[(size_t) i % (sizeof (awkward) / sizeof (awkward[0]))];
+        };
+
+        auto isBounded = [] (const std::vector<Sample>& data)
+        {
+            for (auto sample : data)
+                if (! (std::abs (sample) <= Sample (1)))
+                    return false;
+
+            return true;
+        };
+
+        std::vector<Sample> data ((size_t) numSamples);
+
+        for (int mode = 0; mode < 3; ++mode)
+        {
+            fill (data);
+            kernels.get<Sample> ((FuzzMode) mode) (data.data(), numSamples, unity, unity, unity, 20.0f);
+
+            if (mode == (int) FuzzMode::Black)
+                expect (isBounded (data), "Black stays within +/-1 for NaN and inf input");
+
+            AdaaState state;
+            fill (data);
+            kernels.getAdaa<Sample> ((FuzzMode) mode) (data.data(), numSamples, unity, unity, unity, 20.0f, state);
+        }
+
+        if constexpr (std::is_same<Sample, float>::value)
+        {
+            for (auto interpolation : { Interpolation::Linear, Interpolation::Cubic })
+            {
+                WaveshaperTable table (1024, interpolation);
+                fill (data);
+                kernels.getBlackTable (interpolation) (data.data(), numSamples, unity, unity, unity, 20.0f, table);
+
+                expect (isBounded (data), "the Black table stays within +/-1 for NaN and inf input");
+            }
+        }
+    }
+
+    //==============================================================================
+    /** Skipping silence mustn't cut off anything the filters are still
+        ringing with, or let it come back when the sound does.
+    */
+    void testSilenceSkipping (int numStages, OversamplingFilter filter)
+    {
+        const int numSamples = 48000;
+        const int blockSize = 64;
+
+        std::vector<float> whole ((size_t) numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto sounding = i < 3000 || (i > 20000 && i < 21000);
+            whole[(size_t) i] = sounding ? 0.8f * std::sin ((float) i * 0.3f) + 0.2f * std::sin ((float) i * 2.9f) : 0.0f;
+        }
+
+        auto blocks = whole;
+
+        FuzzProcessor<float> unskipped, skipping;
+
+        for (auto* processor : { &unskipped, &skipping })
+        {
+            processor->setParameters (FuzzParameters::fromRaw (24.0f, 25.0f, 24.0f, 0.0f, 100.0f));
+            processor->setOversampling (numStages, filter);
+        }
+
+        // a block as long as the whole signal never gets to skip
+        unskipped.prepare (48000.0, numSamples, 1);
+        skipping.prepare (48000.0, blockSize, 1);
+
+        auto* channel = whole.data();
+        unskipped.process (&channel, 1, numSamples);
+
+        auto skipped = false;
+
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            channel = blocks.data() + start;
+            skipped |= ! skipping.process (&channel, 1, blockSize);
+        }
+
+        double error = 0.0;
+
+        for (int i = 0; i < numSamples; ++i)
+            error = std::max (error, (double) std::abs (whole[(size_t) i] - blocks[(size_t) i]));
+
+        std::printf ("%dx %s: tail %d, skipping changes the output by %.2e\n", 1 << numStages, getFilterName (filter),
+                     skipping.getTailLengthSamples(), error);
+
+        expect (skipped, "silence is skipped");
+        expect (error <= silenceLevel, "skipping silence doesn't change the output");
+    }
+}
+
+//==============================================================================
+// every form, so array allocations are counted too and nothing is freed by
+// a different allocator than it came from
+void* operator new (std::size_t size)
+{
+    if (countingAllocations)
+        ++numAllocations;
+
+    if (auto* memory = std::malloc (size > 0 ? size : 1))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)     { return operator new (size); }
+
+// out of line, or GCC inlines free() into callers, sees it given memory from
+// operator new and warns about a mismatch
+#if defined (__GNUC__)
+ __attribute__ ((noinline))
+#endif
+static void release (void* memory) noexcept { std::free (memory); }
+
+void operator delete (void* memory) noexcept                    { release (memory); }
+void operator delete (void* memory, std::size_t) noexcept       { release (memory); }
+void operator delete[] (void* memory) noexcept                  { release (memory); }
+void operator delete[] (void* memory, std::size_t) noexcept     { release (memory); }
+
+int main()
+{
+    std::printf ("kernels: %s\n", getInstructionSetName (getPreferredFuzzKernels().instructionSet));
+
+    for (int stages = 1; stages <= Oversampler<float>::maxStages; ++stages)
+    {
+        for (auto filter : { OversamplingFilter::MinimumPhase, OversamplingFilter::LinearPhase })
+        {
+            testLatencyAlignment<float> (stages, filter);
+            testLatencyAlignment<double> (stages, filter);
+            testSilenceSkipping (stages, filter);
+        }
+    }
+
+    testNoAllocationsInProcess();
+    testMatchesKernelsAt1x<float>();
+    testMatchesKernelsAt1x<double>();
+
+    for (auto isa : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2,
+                      InstructionSet::AVX512, InstructionSet::NEON })
+    {
+        if (isInstructionSetSupported (isa))
+        {
+            testNonFiniteInput<float> (isa);
+            testNonFiniteInput<double> (isa);
+        }
+    }
+
+    if (numFailures > 0)
+    {
+        std::printf ("%d checks failed\n", numFailures);
+        return 1;
+    }
+
+    std::printf ("all passed\n");
+    return 0;
+}